@@ -0,0 +1,162 @@
+/*
+ *  sfs-framework
+ *
+ *      Nils Hamel - nils.hamel@bluewin.ch
+ *      Charles Papon - charles.papon.90@gmail.com
+ *      Copyright (c) 2019-2020 DHLAB, EPFL & HES-SO Valais-Wallis
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framework-aggregate.hpp"
+
+void AggregateCorrelation::build(uint32_t queryCount, std::vector<std::vector<cv::DMatch>*> * matches){
+
+    // Count entries of each row
+    rows.assign(queryCount+1, 0);
+    for(auto localMatches : *matches){
+        for(auto & match : *localMatches){
+            rows[match.queryIdx+1]++;
+        }
+    }
+
+    // Rows offset
+    for(uint32_t i=0; i<queryCount; i++){
+        rows[i+1]+=rows[i];
+    }
+
+    // Fill rows in local viewpoints order
+    locals.resize(rows[queryCount]);
+    trains.resize(rows[queryCount]);
+    std::vector<uint32_t> fill(rows.begin(), rows.end()-1);
+    for(uint32_t localIdx=0; localIdx<matches->size(); localIdx++){
+        for(auto & match : *(*matches)[localIdx]){
+            locals[fill[match.queryIdx]]=localIdx;
+            trains[fill[match.queryIdx]++]=match.trainIdx;
+        }
+    }
+
+}
+
+uint32_t AggregateCorrelation::getCount(){
+
+    // Return amount of entries
+    return rows.back();
+
+}
+
+AggregateUnion::AggregateUnion(){
+
+    // Empty forest
+    parentsCapacity=0;
+    keysCapacity=0;
+    keysBits=0;
+    keysBase=0;
+
+}
+
+void AggregateUnion::reset(uint32_t nodes, uint32_t structures){
+
+    // Structures table size - power of two at least twice the amount of possible structures
+    keysBits=1;
+    while((1u<<keysBits)<2*structures){
+        keysBits++;
+    }
+
+    // Structures nodes follow the features nodes
+    keysBase=nodes;
+
+    // Grow storage when required - allocation kept across calls
+    if(parentsCapacity<nodes+(1u<<keysBits)){
+        parentsCapacity=nodes+(1u<<keysBits);
+        parents.reset(new std::atomic<uint32_t>[parentsCapacity]);
+    }
+    if(keysCapacity<(1u<<keysBits)){
+        keysCapacity=1u<<keysBits;
+        keys.reset(new std::atomic<Structure*>[keysCapacity]);
+    }
+
+    // Initialise singletons
+    # pragma omp parallel for
+    for(uint32_t i=0; i<nodes+(1u<<keysBits); i++){
+        parents[i].store(i, std::memory_order_relaxed);
+    }
+
+    // Initialise structures table
+    for(uint32_t i=0; i<(1u<<keysBits); i++){
+        keys[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+}
+
+uint32_t AggregateUnion::find(uint32_t node){
+
+    // Climb to root with path halving
+    uint32_t parent(parents[node].load(std::memory_order_acquire));
+    while(parent!=node){
+        uint32_t grand(parents[parent].load(std::memory_order_acquire));
+        parents[node].compare_exchange_weak(parent, grand, std::memory_order_acq_rel);
+        node=parent;
+        parent=parents[node].load(std::memory_order_acquire);
+    }
+
+    // Return root
+    return node;
+
+}
+
+void AggregateUnion::merge(uint32_t first, uint32_t second){
+
+    // Link roots until they agree - larger root always attached below smaller one
+    while(true){
+
+        // Search current roots
+        first=find(first);
+        second=find(second);
+
+        // Check already merged
+        if(first==second){
+            return;
+        }
+
+        // Order roots
+        if(first<second){
+            std::swap(first, second);
+        }
+
+        // Attach root - retry if another thread modified it in the meantime
+        uint32_t expected(first);
+        if(parents[first].compare_exchange_strong(expected, second, std::memory_order_acq_rel)){
+            return;
+        }
+
+    }
+
+}
+
+uint32_t AggregateUnion::getStructureNode(Structure * structure){
+
+    // Hash structure address
+    uint32_t slot((uint64_t(reinterpret_cast<uintptr_t>(structure)>>4)*0x9E3779B97F4A7C15ull)>>(64-keysBits));
+
+    // Linear probing - claim empty slot or find structure
+    while(true){
+        Structure * expected(nullptr);
+        if(keys[slot].compare_exchange_strong(expected, structure, std::memory_order_acq_rel)||(expected==structure)){
+            return keysBase+slot;
+        }
+        slot=(slot+1)&((1u<<keysBits)-1);
+    }
+
+}
@@ -0,0 +1,70 @@
+/*
+ *  sfs-framework
+ *
+ *      Nils Hamel - nils.hamel@bluewin.ch
+ *      Charles Papon - charles.papon.90@gmail.com
+ *      Copyright (c) 2019-2020 DHLAB, EPFL & HES-SO Valais-Wallis
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// External includes
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <opencv4/opencv2/core.hpp>
+#include <omp.h>
+
+// Internal includes
+#include "framework-structure.hpp"
+
+// Define empty node
+#define AGGREGATE_NULL ( 0xFFFFFFFF )
+
+// Module object
+class AggregateCorrelation {
+
+public: /* Need to be set back to private */
+    std::vector<uint32_t> rows;   /* Entries offset of each new viewpoint feature - one more than features */
+    std::vector<uint32_t> locals; /* Local viewpoint of each entry */
+    std::vector<uint32_t> trains; /* Local viewpoint feature of each entry */
+
+public:
+    void build(uint32_t queryCount, std::vector<std::vector<cv::DMatch>*> * matches);
+    uint32_t getCount();
+
+};
+
+// Module object
+class AggregateUnion {
+
+private:
+    std::unique_ptr<std::atomic<uint32_t>[]> parents;
+    std::unique_ptr<std::atomic<Structure*>[]> keys;
+    uint32_t parentsCapacity;
+    uint32_t keysCapacity;
+    uint32_t keysBits;
+    uint32_t keysBase;
+
+public:
+    AggregateUnion();
+    void reset(uint32_t nodes, uint32_t structures);
+    uint32_t find(uint32_t node);
+    void merge(uint32_t first, uint32_t second);
+    uint32_t getStructureNode(Structure * structure);
+
+};
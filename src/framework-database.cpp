@@ -25,7 +25,7 @@
 //  Framework core functions
 //
 
-Database::Database(double initialError, double initialErrorDisparity, double initialRadius, unsigned int initialGroup, unsigned int initialMatchRange, double initialDenseDisparity){
+Database::Database(double initialError, double initialErrorDisparity, double initialRadius, unsigned int initialGroup, unsigned int initialMatchRange, unsigned int initialMatchMinimum, unsigned int initialMatchOverlap, double initialDenseDisparity, int initialTriangulation){
 
     // Assign default parameters
     configError=initialError;
@@ -33,7 +33,20 @@ Database::Database(double initialError, double initialErrorDisparity, double ini
     configRadius=initialRadius;
     configGroup=initialGroup;
     configMatchRange=initialMatchRange;
+    configMatchMinimum=MIN(MAX(initialMatchMinimum,1u),initialMatchRange);
+    configMatchOverlap=initialMatchOverlap;
     configDenseDisparity=initialDenseDisparity;
+    configTriangulation=initialTriangulation;
+
+    // Initialise retired viewpoints statistics
+    frozenCount=0;
+    frozenMemory=0;
+
+    // Initialise adaptive window statistics
+    matchSkipped=0;
+
+    // No structures preparation yet
+    preparedCount=0;
 
     // Check consistency
     if(configGroup<3){
@@ -112,11 +125,50 @@ bool Database::getError(int pipeState, int loopMajor, int loopMinor){
 
 }
 
-void Database::getLocalViewpoints(Eigen::Vector3d position, std::vector<std::shared_ptr<Viewpoint>> *localViewpoints){
+bool Database::getAdaptive(){
+
+    // Adaptive window enabled when the minimum range is below the maximum one
+    return configMatchMinimum<configMatchRange;
+
+}
+
+void Database::getLocalViewpoints(Eigen::Vector3d position, unsigned int inliers, std::vector<std::shared_ptr<Viewpoint>> *localViewpoints){
 
     // Detect amout of available last viewpoints
     int localCount = MIN(configMatchRange, viewpoints.size());
 
+    // Adaptive window - requires the inliers count and the predicted baseline of the last pair
+    if(getAdaptive()&&(inliers>0)&&(localCount>0)){
+
+        // Predicted baseline to the last viewpoint
+        double lastBaseline((position-viewpoints.back()->position).norm());
+
+        // Skip adaptation on degenerated baseline
+        if(lastBaseline>0.){
+
+            // Keep the minimum range in any case
+            int adaptiveCount = MIN(int(configMatchMinimum), localCount);
+
+            // Extend the window while the expected overlap stays large enough - inliers assumed to decay as the inverse of the baseline
+            while(adaptiveCount<localCount){
+                double baseline((position-viewpoints[viewpoints.size()-1-adaptiveCount]->position).norm());
+                if(double(inliers)*lastBaseline<double(configMatchOverlap)*baseline){
+                    break;
+                }
+                adaptiveCount++;
+            }
+
+            // Update and display skipped matcher calls
+            matchSkipped+=localCount-adaptiveCount;
+            std::cout << "matchWindow=" << adaptiveCount << "/" << localCount << " matchSkipped=" << localCount-adaptiveCount << " matchSkippedTotal=" << matchSkipped << std::endl;
+
+            // Apply adaptive range
+            localCount=adaptiveCount;
+
+        }
+
+    }
+
     // Add available to stack for matching
     for(auto availableViewpoint(viewpoints.end()-localCount); availableViewpoint != viewpoints.end(); ++availableViewpoint){
         localViewpoints->push_back(*availableViewpoint);
@@ -124,6 +176,21 @@ void Database::getLocalViewpoints(Eigen::Vector3d position, std::vector<std::sha
 
 }
 
+bool Database::getPrediction(Viewpoint * viewpoint){
+
+    // Check availability of optimised transformations
+    if(getBootstrap()||transforms.empty()){
+        return false;
+    }
+
+    // Extrapolate pose assuming constant motion - last transformation applied on last viewpoint
+    transforms.back()->computeFrame(viewpoints.back().get(), viewpoint);
+
+    // Prediction available
+    return true;
+
+}
+
 void Database::addViewpoint(std::shared_ptr<Viewpoint> viewpoint){
 
     // Add new viewpoint to the stack
@@ -134,12 +201,40 @@ void Database::addViewpoint(std::shared_ptr<Viewpoint> viewpoint){
         transforms.push_back(std::make_shared<Transform>());
     }
 
+    // Freeze viewpoint leaving the match window
+    if(viewpoints.size()>std::max(configMatchRange,1u)){
+
+        // Retired viewpoint
+        Viewpoint * frozen(viewpoints[viewpoints.size()-1-std::max(configMatchRange,1u)].get());
+
+        // Memory before retirement
+        size_t memory(frozen->getMemory());
+
+        // Drop descriptors, keypoints and unstructured features
+        frozen->freeze();
+
+        // Update retired viewpoints statistics
+        frozenCount ++;
+        frozenMemory+=frozen->getMemory();
+
+        // Display retirement statistics
+        std::cout << "viewpointFrozen=" << frozen->getIndex() << " memoryActive=" << memory << " memoryFrozen=" << frozen->getMemory() << " memoryRetired=" << frozenMemory << " (" << frozenCount << " viewpoints)" << std::endl;
+
+    }
+
 }
 
 Structure * Database::addStructure(){
 
-    // Create structure memory allocation
-    auto newStructure = std::make_shared<Structure>(); 
+    // Create and push new structure
+    return addStructure(std::make_shared<Structure>());
+
+}
+
+Structure * Database::addStructure(std::shared_ptr<Structure> newStructure){
+
+    // Assign stack position
+    newStructure->slot = structures.size();
 
     // Push new structure on the stack
     structures.push_back(newStructure); 
@@ -149,107 +244,146 @@ Structure * Database::addStructure(){
 
 }
 
-void Database::aggregate(std::vector<std::shared_ptr<Viewpoint>> *localViewpoints, Viewpoint *newViewpoint, uint32_t *correlations){
+void Database::aggregate(std::vector<std::shared_ptr<Viewpoint>> *localViewpoints, Viewpoint *newViewpoint, AggregateCorrelation *correlation){
     uint32_t localViewpointsCount = localViewpoints->size();
-    Structure** structures = new Structure*[localViewpointsCount];
-    uint32_t* structuresOccurences = new uint32_t[localViewpointsCount];
+    uint32_t queryCount = newViewpoint->features.size();
     uint32_t structureNewCount = 0;
     uint32_t structureAggregationCount = 0;
     uint32_t structureFusionCount = 0;
-    uint32_t *viewpointsUsage = new uint32_t[viewpoints.size() + 1];
-    memset(viewpointsUsage, -1, (viewpoints.size() + 1)*sizeof(uint32_t));
+    uint32_t structureDroppedCount = 0;
 
-    // loop on new viewpoint feature
-    for(uint32_t queryIdx = 0;queryIdx < newViewpoint->features.size(); queryIdx++){
-        uint32_t *correlationsPtr = correlations + queryIdx*localViewpointsCount; //Used to iterate over the given lines
+    //Nodes offsets - local viewpoints features followed by the new viewpoint features
+    std::vector<uint32_t> offsets(localViewpointsCount + 1, 0);
+    for(uint32_t localIdx = 0;localIdx < localViewpointsCount;localIdx++){
+        offsets[localIdx + 1] = offsets[localIdx] + (*localViewpoints)[localIdx]->features.size();
+    }
+    uint32_t queryOffset = offsets[localViewpointsCount];
 
-        uint32_t structuresCount = 0;
-        uint32_t matchCount = 0;
+    //Window sized forest - one node per feature and per pre-existing structure, bounded by the matches count
+    aggregateUnion.reset(queryOffset + queryCount, correlation->getCount());
 
-        //Collect all the existing structures of the matches and count their occurences
-        for(uint32_t localIdx = 0;localIdx < localViewpointsCount;localIdx++){
-            uint32_t trainIdx = correlationsPtr[localIdx];
-            if(trainIdx != 0xFFFFFFFF){
-                matchCount++;
-                auto localFeature = (*localViewpoints)[localIdx]->getFeatureFromCvIndex(trainIdx);
-                auto localStructure = localFeature->structure;
-                if(localStructure){
-                    uint32_t cacheIdx;
-                    for(cacheIdx = 0;cacheIdx < structuresCount; cacheIdx++){
-                        if(structures[cacheIdx] == localStructure){
-                            structuresOccurences[cacheIdx]++;
-                            break;
-                        }
-                    }
-                    if(cacheIdx == structuresCount){ //No cache hit
-                        structures[cacheIdx] = localStructure;
-                        structuresOccurences[cacheIdx] = 1;
-                        structuresCount++;
+    //Join matched features, and matched features with their pre-existing structure
+    # pragma omp parallel for schedule(dynamic)
+    for(uint32_t queryIdx = 0;queryIdx < queryCount;queryIdx++){
+        for(uint32_t entryIdx = correlation->rows[queryIdx];entryIdx < correlation->rows[queryIdx + 1];entryIdx++){
+            uint32_t localIdx = correlation->locals[entryIdx];
+            uint32_t trainIdx = correlation->trains[entryIdx];
+            aggregateUnion.merge(queryOffset + queryIdx, offsets[localIdx] + trainIdx);
+            auto localStructure = (*localViewpoints)[localIdx]->getFeatureFromCvIndex(trainIdx)->structure;
+            if(localStructure){
+                aggregateUnion.merge(offsets[localIdx] + trainIdx, aggregateUnion.getStructureNode(localStructure));
+            }
+        }
+    }
+
+    //Component of each matched new viewpoint feature
+    std::vector<uint32_t> roots(queryCount, AGGREGATE_NULL);
+    # pragma omp parallel for
+    for(uint32_t queryIdx = 0;queryIdx < queryCount;queryIdx++){
+        if(correlation->rows[queryIdx + 1] > correlation->rows[queryIdx]){
+            roots[queryIdx] = aggregateUnion.find(queryOffset + queryIdx);
+        }
+    }
+
+    //Group new viewpoint features by component - no match => no integration
+    std::vector<std::pair<uint32_t, uint32_t>> members;
+    for(uint32_t queryIdx = 0;queryIdx < queryCount;queryIdx++){
+        if(roots[queryIdx] == AGGREGATE_NULL) continue;
+        if(newViewpoint->getFeatureFromCvIndex(queryIdx)->structure) throw std::runtime_error("New feature already had a structure");
+        members.emplace_back(roots[queryIdx], queryIdx);
+    }
+    std::sort(members.begin(), members.end());
+
+    //Components boundaries
+    std::vector<uint32_t> components;
+    for(uint32_t memberIdx = 0;memberIdx < members.size();memberIdx++){
+        if(memberIdx == 0 || members[memberIdx].first != members[memberIdx - 1].first) components.push_back(memberIdx);
+    }
+    uint32_t componentsCount = components.size();
+    components.push_back(members.size());
+
+    //Structures created by the components, with their creating new viewpoint feature
+    std::vector<std::vector<std::pair<uint32_t, std::shared_ptr<Structure>>>> componentCreated(componentsCount);
+
+    //Resolve components - each one owns its structures and features, its queries are resolved in order on their own majority structure
+    # pragma omp parallel for schedule(dynamic) reduction(+:structureNewCount,structureAggregationCount,structureFusionCount,structureDroppedCount)
+    for(uint32_t componentIdx = 0;componentIdx < componentsCount;componentIdx++){
+        std::vector<std::pair<Structure*, uint32_t>> votes;
+        std::vector<unsigned int> viewpointsUsage;
+        for(uint32_t memberIdx = components[componentIdx];memberIdx < components[componentIdx + 1];memberIdx++){
+            uint32_t queryIdx = members[memberIdx].second;
+
+            //Collect the structures of the matches and count their occurences
+            votes.clear();
+            for(uint32_t entryIdx = correlation->rows[queryIdx];entryIdx < correlation->rows[queryIdx + 1];entryIdx++){
+                uint32_t localIdx = correlation->locals[entryIdx];
+                uint32_t trainIdx = correlation->trains[entryIdx];
+                auto localStructure = (*localViewpoints)[localIdx]->getFeatureFromCvIndex(trainIdx)->structure;
+                if(!localStructure) continue;
+                uint32_t voteIdx;
+                for(voteIdx = 0;voteIdx < votes.size();voteIdx++){
+                    if(votes[voteIdx].first == localStructure){
+                        votes[voteIdx].second++;
+                        break;
                     }
                 }
+                if(voteIdx == votes.size()) votes.emplace_back(localStructure, 1);
             }
-        }
 
-        //Figure out which structure will be used to integrate the newViewpoint feature
-        if(matchCount == 0) continue; //No match => no integration
-        //if(matchCount < 2) continue;
-        Structure *structure = NULL;
-        switch(structuresCount){
-            case 0: {
-                // no more needed - direct access to structure
-                structure = this->addStructure();
+            //Figure out which structure will be used to integrate the new viewpoint feature - created when only orphans are matched
+            Structure *structure = NULL;
+            if(votes.empty()){
+                componentCreated[componentIdx].emplace_back(queryIdx, std::make_shared<Structure>());
+                structure = componentCreated[componentIdx].back().second.get();
                 structureNewCount++;
-            }break;
-            case 1: {
-                //if(structuresOccurences[0] < 2) continue; //Not good enough
-                if(structuresOccurences[0] < 1) continue; //Not good enough
-                structure = structures[0];
-                structureAggregationCount++;
-            }break;
-            default: {
-                // search for best structure //
+            }else{
                 uint32_t detectIdx = 0;
-                for ( uint32_t seachMax = 0, searchIdx = 0; searchIdx < structuresCount; searchIdx++ ) {
-                    if(structuresOccurences[searchIdx]>seachMax){
-                        seachMax=structuresOccurences[searchIdx];
-                        detectIdx=searchIdx;
-                    }
+                for(uint32_t voteIdx = 1;voteIdx < votes.size();voteIdx++){
+                    if(votes[voteIdx].second > votes[detectIdx].second) detectIdx = voteIdx;
                 }
-                if(structuresOccurences[detectIdx] < 1) continue;
-                structure = structures[detectIdx];
-                structureFusionCount++;
-                //continue; // de-activate match fusion
-            }break;
-        }
+                structure = votes[detectIdx].first;
+                if(votes.size() == 1) structureAggregationCount++; else structureFusionCount++;
+            }
 
-        //Populate pre-existing viewpoint usage from the structure
-        for(auto f : structure->features){
-            viewpointsUsage[f->viewpoint->index] = queryIdx;
-        }
+            //Viewpoints already used by the structure
+            viewpointsUsage.clear();
+            for(auto f : structure->features){
+                viewpointsUsage.push_back(f->getViewpoint()->getIndex());
+            }
 
-        //Integrate all orphan feature into the common structure
-        for(uint32_t localIdx = 0;localIdx < localViewpointsCount;localIdx++){
-            uint32_t trainIdx = correlationsPtr[localIdx];
-            if(trainIdx != 0xFFFFFFFF){
+            //Integrate orphan features into the structure, one per viewpoint
+            for(uint32_t entryIdx = correlation->rows[queryIdx];entryIdx < correlation->rows[queryIdx + 1];entryIdx++){
+                uint32_t localIdx = correlation->locals[entryIdx];
+                uint32_t trainIdx = correlation->trains[entryIdx];
                 auto localFeature = (*localViewpoints)[localIdx]->getFeatureFromCvIndex(trainIdx);
                 auto viewpointId = (*localViewpoints)[localIdx]->index;
-                if(!localFeature->structure && viewpointsUsage[viewpointId] != queryIdx){
-                    viewpointsUsage[viewpointId] = queryIdx;
-                    structure->addFeature((*localViewpoints)[localIdx]->getFeatureFromCvIndex(trainIdx));
+                if(!localFeature->structure && std::find(viewpointsUsage.begin(), viewpointsUsage.end(), viewpointId) == viewpointsUsage.end()){
+                    viewpointsUsage.push_back(viewpointId);
+                    structure->addFeature(localFeature);
                 }
             }
-        }
 
-        auto newFeature = newViewpoint->getFeatureFromCvIndex(queryIdx);
-        if(newFeature->structure) throw std::runtime_error("New feature already had a structure");
-        if(viewpointsUsage[viewpoints.size()] != queryIdx){
-            structure->addFeature(newFeature);
+            //Integrate the new viewpoint feature - dropped when the structure already holds one
+            if(std::find(viewpointsUsage.begin(), viewpointsUsage.end(), newViewpoint->index) == viewpointsUsage.end()){
+                structure->addFeature(newViewpoint->getFeatureFromCvIndex(queryIdx));
+            }else{
+                structureDroppedCount++;
+            }
         }
     }
-    delete[] viewpointsUsage;
-    delete[] structures;
-    delete[] structuresOccurences;
-    std::cout << "structureNewCount=" << structureNewCount << " structureAggregationCount=" << structureAggregationCount << " structureFusionCount=" << structureFusionCount << std::endl;
+
+    //Register created structures - serial, in creating new viewpoint features order
+    std::vector<std::pair<uint32_t, std::shared_ptr<Structure>>> created;
+    for(auto & componentList : componentCreated){
+        created.insert(created.end(), componentList.begin(), componentList.end());
+    }
+    std::sort(created.begin(), created.end(), [](std::pair<uint32_t, std::shared_ptr<Structure>> const & a, std::pair<uint32_t, std::shared_ptr<Structure>> const & b){
+        return a.first < b.first;
+    });
+    for(auto & entry : created){
+        this->addStructure(entry.second);
+    }
+    std::cout << "structureNewCount=" << structureNewCount << " structureAggregationCount=" << structureAggregationCount << " structureFusionCount=" << structureFusionCount << " structureDroppedCount=" << structureDroppedCount << std::endl;
 
 }
 
@@ -266,8 +400,8 @@ int Database::prepareState(int pipeState){
         rangeTlow  = transforms.size()-configGroup+1;
         rangeThigh = transforms.size()-1;
 
-        // Set range : structure
-        rangeSlow  = 0;
+        // Set range : structure - only structures observed by the last viewpoint can be active
+        rangeSlow  = prepareWindow();
         rangeShigh = structures.size()-1;
 
         // Set structure minimal activity
@@ -297,27 +431,79 @@ int Database::prepareState(int pipeState){
 
 }
 
-void Database::prepareStructures(){
+unsigned int Database::prepareWindow(){
 
-    // Parsing structures
-    for(auto & structure: structures){
+    // Tail of the structures stack
+    unsigned int tail(structures.size());
 
-        // Ensure sorting of features based on their viewpoint index
-        structure->sortFeatures();
+    // Gather structures observed by the last viewpoint at the end of the stack
+    for(auto & feature: viewpoints.back()->features){
 
-        // Compute structure state
-        structure->computeState(configGroup, rangeVhigh);
+        // Observed structure
+        Structure * structure(feature->getStructure());
 
-        // Check structure state
-        if(structure->getState()==STRUCTURE_PIONER){
+        // Skip unstructured and already gathered features
+        if((structure==NULL)||(structure->slot>=tail)){
+            continue;
+        }
 
-            // Reset structure
-            structure->setReset();
+        // Swap structure with the first free tail slot
+        tail--;
+        std::swap(structures[structure->slot], structures[tail]);
+        structures[structure->slot]->slot=structure->slot;
+        structure->slot=tail;
+
+    }
+
+    // Return active window first index
+    return tail;
+
+}
+
+void Database::prepareStructure(Structure * structure){
+
+    // Ensure sorting of features based on their viewpoint index
+    structure->sortFeatures();
+
+    // Compute structure state
+    structure->computeState(configGroup, rangeVhigh);
+
+    // Check structure state
+    if(structure->getState()==STRUCTURE_PIONER){
+
+        // Reset structure
+        structure->setReset();
+
+    }
+
+}
+
+void Database::prepareStructures(){
+
+    // Incremental preparation - only structures observed by the last two viewpoints changed since the previous one
+    if((preparedCount>0)&&(viewpoints.size()==preparedCount+1)){
+
+        // Parsing structures observed by the last two viewpoints
+        for(unsigned int i(viewpoints.size()-2); i<viewpoints.size(); i++){
+            for(auto & feature: viewpoints[i]->features){
+                if(feature->getStructure()!=NULL){
+                    prepareStructure(feature->getStructure());
+                }
+            }
+        }
+
+    }else{
 
+        // Parsing structures
+        for(auto & structure: structures){
+            prepareStructure(structure.get());
         }
 
     }
 
+    // Update prepared viewpoints count
+    preparedCount=viewpoints.size();
+
 }
 
 void Database::prepareTransforms(){
@@ -337,6 +523,9 @@ void Database::expungeStructures(){
     // Continuous index
     unsigned int index(0);
 
+    // Viewpoints of detached features
+    std::vector<bool> detached(viewpoints.size(), false);
+
     // Parsing structure
     for(unsigned int i=0; i<structures.size(); i++){
 
@@ -345,11 +534,20 @@ void Database::expungeStructures(){
 
             // Re-indexation
             if(index<i) structures[index]=structures[i];
+            structures[index]->slot=index;
 
             // Update continuous index
             index ++;
 
-        }       
+        }else{
+
+            // Detach features of removed structure - no dangling structure pointer
+            for(auto & feature: structures[i]->features){
+                feature->setStructurePtr(NULL);
+                detached[feature->getViewpoint()->getIndex()]=true;
+            }
+
+        }
 
     }
 
@@ -361,6 +559,23 @@ void Database::expungeStructures(){
 
     }
 
+    // Frozen viewpoints - left the match window, features no more indexed by keypoints
+    unsigned int frozenHigh(viewpoints.size()>std::max(configMatchRange,1u) ? viewpoints.size()-std::max(configMatchRange,1u) : 0);
+
+    // Frozen viewpoints holding unstructured features - detached now or by filtering on the viewpoints range
+    std::vector<unsigned int> releasing;
+    for(unsigned int i(0); i<frozenHigh; i++){
+        if(detached[i]||(i>=rangeVlow)){
+            releasing.push_back(i);
+        }
+    }
+
+    // Delete unstructured features of frozen viewpoints
+    # pragma omp parallel for schedule(dynamic)
+    for(unsigned int i=0; i<releasing.size(); i++){
+        viewpoints[releasing[i]]->releaseFeatures();
+    }
+
 }
 
 void Database::broadcastScale(){
@@ -425,10 +640,13 @@ void Database::computeCentroids(int pipeState){
 
     }
 
+    // Threads contributing to centroids
+    int threads(omp_get_max_threads());
+
     // Reset centroids
     # pragma omp parallel for
     for(unsigned int i=rangeTlow; i<=rangeThigh; i++){
-        transforms[i]->resetCentroid();
+        transforms[i]->resetCentroid(threads);
     }
     
     // Distribute structure contribution to centroids
@@ -459,10 +677,13 @@ void Database::computeCorrelations(int pipeState){
 
     }
 
+    // Threads contributing to correlation matrix
+    int threads(omp_get_max_threads());
+
     // Reset correlation matrix
     # pragma omp parallel for
     for(unsigned int i=rangeTlow; i<=rangeThigh; i++){
-        transforms[i]->resetCorrelation();
+        transforms[i]->resetCorrelation(threads);
     }
 
     // Distribute structure contribution to correlation matrix
@@ -475,6 +696,12 @@ void Database::computeCorrelations(int pipeState){
         }
     }
 
+    // Merge per-thread correlation matrices
+    # pragma omp parallel for
+    for(unsigned int i=rangeTlow; i<=rangeThigh; i++){
+        transforms[i]->computeCorrelation();
+    }
+
 }
 
 void Database::computePoses(int pipeState){
@@ -562,16 +789,83 @@ void Database::computeOriented(int pipeState){ /* param not needed */
 
 void Database::computeOptimals(int pipeState){ /* param not needed */
 
+    // Compare triangulation estimators
+    if(configTriangulation==STRUCTURE_TRIANGULATION_BENCHMARK){
+
+        // Closed-form positions
+        std::vector<Eigen::Vector3d> closed(rangeShigh-rangeSlow+1);
+
+        // Closed-form timing
+        auto timeStart(std::chrono::steady_clock::now());
+
+        // Compute closed-form position of structures
+        # pragma omp parallel for schedule(dynamic)
+        for(unsigned int i=rangeSlow; i<=rangeShigh; i++){
+            if(structures[i]->getState()>=stateStructure){
+                structures[i]->computeClosedPosition(rangeVlow);
+                closed[i-rangeSlow]=*structures[i]->getPosition();
+            }
+        }
+
+        // Pairwise timing
+        auto timeClosed(std::chrono::steady_clock::now());
+
+        // Compute pairwise position of structures - kept as result
+        # pragma omp parallel for schedule(dynamic)
+        for(unsigned int i=rangeSlow; i<=rangeShigh; i++){
+            if(structures[i]->getState()>=stateStructure){
+                structures[i]->computeOptimalPosition(rangeVlow);
+            }
+        }
+
+        // End timing
+        auto timePairwise(std::chrono::steady_clock::now());
+
+        // Estimators agreement
+        double deviationMean(0.), deviationMax(0.);
+        unsigned int count(0);
+        for(unsigned int i=rangeSlow; i<=rangeShigh; i++){
+            if(structures[i]->getState()>=stateStructure){
+                double deviation((closed[i-rangeSlow]-*structures[i]->getPosition()).norm());
+                if(std::isfinite(deviation)){
+                    deviationMean+=deviation;
+                    deviationMax=std::max(deviationMax,deviation);
+                    count++;
+                }
+            }
+        }
+
+        // Display comparison
+        std::cerr << "Triangulation : closed " << std::chrono::duration<double,std::milli>(timeClosed-timeStart).count() << " ms"
+                  << " | pairwise " << std::chrono::duration<double,std::milli>(timePairwise-timeClosed).count() << " ms"
+                  << " | deviation mean " << (count>0 ? deviationMean/count : 0.) << " max " << deviationMax
+                  << " (" << count << " structures)" << std::endl;
+
+        return;
+
+    }
+
     // Compute absolute optimal position of structures
     # pragma omp parallel for schedule(dynamic)
     for(unsigned int i=rangeSlow; i<=rangeShigh; i++){
         if(structures[i]->getState()>=stateStructure){
-            structures[i]->computeOptimalPosition(rangeVlow);
+            computeOptimal(structures[i].get());
         }
     }
 
 }
 
+void Database::computeOptimal(Structure * structure){
+
+    // Compute structure position with the configured estimator - pairwise when benchmarking
+    if(configTriangulation==STRUCTURE_TRIANGULATION_CLOSED){
+        structure->computeClosedPosition(rangeVlow);
+    }else{
+        structure->computeOptimalPosition(rangeVlow);
+    }
+
+}
+
 void Database::computeRadii(int pipeState){ /* param not needed */
 
     // Compute feature radii according to optimal position
@@ -654,6 +948,136 @@ void Database::filterDisparity(int pipeState){
 
 }
 
+void Database::computeFused(int pipeState, bool fusedCheck){
+
+    // Threads contributing to moments
+    int threads(omp_get_max_threads());
+
+    // Fused and separate passes deviations
+    double deviationCentroid(0.);
+    double deviationCorrelation(0.);
+
+    // Phase : features models and transformations moments - single sweep on structures
+    if(pipeState!=DB_MODE_MASS){
+
+        // Reset centroids and correlation matrix
+        # pragma omp parallel for
+        for(unsigned int i=rangeTlow; i<=rangeThigh; i++){
+            transforms[i]->resetCentroid(threads);
+            transforms[i]->resetCorrelation(threads);
+        }
+
+        // Compute models and distribute structure contribution to moments
+        # pragma omp parallel for schedule(dynamic)
+        for(unsigned int i=rangeSlow; i<=rangeShigh; i++){
+            if(structures[i]->getState()>=stateStructure){
+                structures[i]->computeModel();
+                if(structures[i]->getHasScale(configGroup)){
+                    structures[i]->computeMoments(transforms,rangeVlow);
+                }
+            }
+        }
+
+        // Barrier : centroids and correlation matrix from moments
+        # pragma omp parallel for
+        for(unsigned int i=rangeTlow; i<=rangeThigh; i++){
+            transforms[i]->computeMoments();
+        }
+
+        // Compare with separate passes - fused results kept
+        if(fusedCheck==true){
+
+            // Fused results
+            std::vector<Transform> fused;
+            for(unsigned int i=rangeTlow; i<=rangeThigh; i++){
+                fused.push_back(*transforms[i]);
+            }
+
+            // Separate passes on the same models
+            computeCentroids(pipeState);
+            computeCorrelations(pipeState);
+
+            // Relative deviations and fused results restoration
+            for(unsigned int i=rangeTlow; i<=rangeThigh; i++){
+                Transform & reference(fused[i-rangeTlow]);
+                deviationCentroid=std::max(deviationCentroid,std::max((reference.centerFirst-transforms[i]->centerFirst).norm()/transforms[i]->centerFirst.norm(),(reference.centerSecond-transforms[i]->centerSecond).norm()/transforms[i]->centerSecond.norm()));
+                deviationCorrelation=std::max(deviationCorrelation,(reference.correlation-transforms[i]->correlation).norm()/transforms[i]->correlation.norm());
+                transforms[i]->centerFirst=reference.centerFirst;
+                transforms[i]->centerSecond=reference.centerSecond;
+                transforms[i]->correlation=reference.correlation;
+                transforms[i]->count=reference.count;
+            }
+
+        }
+
+    }
+
+    // Barrier : poses, normalisation and frames chain
+    computePoses(pipeState);
+    computeNormalisePoses(pipeState);
+    computeFrames(pipeState);
+
+    // Disparity moments - one slot per thread
+    std::vector<double> moments(threads*DB_MOMENTS_STRIDE, 0.);
+
+    // Phase : oriented features, optimal positions, radii, radial filtering and disparity moments - single sweep on structures
+    # pragma omp parallel for schedule(dynamic)
+    for(unsigned int i=rangeSlow; i<=rangeShigh; i++){
+        if(structures[i]->getState()>=stateStructure){
+            structures[i]->computeOriented(rangeVlow);
+            computeOptimal(structures[i].get());
+            structures[i]->computeRadius(rangeVlow);
+            structures[i]->filterRadialRange(0.,configRadius,rangeVlow);
+        }
+        if(structures[i]->getState()>=stateStructure){
+            if(structures[i]->getHasScale(configGroup)){
+                double * moment(moments.data()+omp_get_thread_num()*DB_MOMENTS_STRIDE);
+                structures[i]->computeDisparityMoments(moment+DB_MOMENTS_COUNT,moment+DB_MOMENTS_MEAN,moment+DB_MOMENTS_SQUARE,rangeVlow);
+            }
+        }
+    }
+
+    // Barrier : merge disparity moments - pairwise update of Chan et al.
+    double countValue(0.);
+    double squareValue(0.);
+    meanValue=0.;
+    for(unsigned int i(0); i<moments.size(); i+=DB_MOMENTS_STRIDE){
+        if(moments[i+DB_MOMENTS_COUNT]>0.){
+            double delta(moments[i+DB_MOMENTS_MEAN]-meanValue);
+            double merge(countValue+moments[i+DB_MOMENTS_COUNT]);
+            squareValue+=moments[i+DB_MOMENTS_SQUARE]+delta*delta*countValue*moments[i+DB_MOMENTS_COUNT]/merge;
+            meanValue+=delta*moments[i+DB_MOMENTS_COUNT]/merge;
+            countValue=merge;
+        }
+    }
+
+    // Disparity statistics from moments
+    stdValue=std::sqrt(squareValue/(countValue-1.));
+
+    // Compare with separate passes - fused results kept
+    if(fusedCheck==true){
+
+        // Fused statistics
+        double fusedMean(meanValue);
+        double fusedStd(stdValue);
+
+        // Separate passes on the same disparities
+        computeDisparityStatistics(pipeState);
+
+        // Display relative deviations
+        std::cout << "fusedCentroidDeviation=" << deviationCentroid << " fusedCorrelationDeviation=" << deviationCorrelation << " fusedDisparityMeanDeviation=" << std::fabs(fusedMean-meanValue)/std::fabs(meanValue) << " fusedDisparityStdDeviation=" << std::fabs(fusedStd-stdValue)/stdValue << std::endl;
+
+        // Restore fused statistics
+        meanValue=fusedMean;
+        stdValue=fusedStd;
+
+    }
+
+    // Phase : filtering on disparity
+    filterDisparity(pipeState);
+
+}
+
 //
 //  Framework exportation
 //
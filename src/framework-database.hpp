@@ -25,6 +25,7 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
 #include <cmath>
 #include <omp.h>
 #include <sstream>
@@ -36,6 +37,7 @@
 #include "framework-viewpoint.hpp"
 #include "framework-transform.hpp"
 #include "framework-structure.hpp"
+#include "framework-aggregate.hpp"
 
 // Namespaces
 namespace fs = std::experimental::filesystem;
@@ -51,6 +53,15 @@ namespace fs = std::experimental::filesystem;
 #define DB_MODE_FULL       (  4 ) /* Optimising all structures */ /* Need deletion */
 #define DB_MODE_MASS       (  5 ) /* Only compute position of structures and strict filter */
 
+// Adaptive match window - default inliers expected with the oldest kept viewpoint
+#define DB_MATCH_OVERLAP   ( 64 )
+
+// Fused iteration per-thread disparity moments layout - count, mean and squared deviations, padded against false sharing
+#define DB_MOMENTS_COUNT   ( 0 )
+#define DB_MOMENTS_MEAN    ( 1 )
+#define DB_MOMENTS_SQUARE  ( 2 )
+#define DB_MOMENTS_STRIDE  ( 8 )
+
 // Module object
 class Database {
 
@@ -66,6 +77,9 @@ public: /* Need to be set back to private */
 
     unsigned int configGroup;
     unsigned int configMatchRange;
+    unsigned int configMatchMinimum;
+    unsigned int configMatchOverlap;
+    int configTriangulation;
 
     double transformMean;
     double meanValue;
@@ -79,16 +93,30 @@ public: /* Need to be set back to private */
     unsigned int rangeShigh; /* Structures range last index */
     unsigned int stateStructure; /* Structure state */
 
+    unsigned int frozenCount;  /* Amount of viewpoints retired from the match window */
+    size_t frozenMemory;       /* Memory held by retired viewpoints */
+
+    unsigned long matchSkipped; /* Amount of matcher calls saved by the adaptive window */
+
+    AggregateUnion aggregateUnion; /* Tracks forest reused across aggregations */
+
+    size_t preparedCount; /* Amount of viewpoints at last structures preparation */
+
 public:
-    Database(double initialError, double initialErrorDisparity, double initialRadius, unsigned int initialGroup, unsigned int initialMatchRange, double initialDenseDisparity);
+    Database(double initialError, double initialErrorDisparity, double initialRadius, unsigned int initialGroup, unsigned int initialMatchRange, unsigned int initialMatchMinimum, unsigned int initialMatchOverlap, double initialDenseDisparity, int initialTriangulation);
     bool getBootstrap();
     unsigned int getGroup();
+    bool getAdaptive();
     bool getError(int loopState, int loopMajor, int loopMinor);
-    void getLocalViewpoints(Eigen::Vector3d position, std::vector<std::shared_ptr<Viewpoint>> *localViewpoints);
+    void getLocalViewpoints(Eigen::Vector3d position, unsigned int inliers, std::vector<std::shared_ptr<Viewpoint>> *localViewpoints);
+    bool getPrediction(Viewpoint * viewpoint);
 	void addViewpoint(std::shared_ptr<Viewpoint> viewpoint);
     Structure * addStructure();
-    void aggregate(std::vector<std::shared_ptr<Viewpoint>> *localViewpoints, Viewpoint *newViewpoint, uint32_t *correlations);
+    Structure * addStructure(std::shared_ptr<Structure> newStructure);
+    void aggregate(std::vector<std::shared_ptr<Viewpoint>> *localViewpoints, Viewpoint *newViewpoint, AggregateCorrelation *correlation);
     int prepareState(int pipeState);
+    unsigned int prepareWindow();
+    void prepareStructure(Structure * structure);
     void prepareStructures();
     void prepareTransforms();
     void expungeStructures();
@@ -101,9 +129,11 @@ public:
     void computeFrames(int loopState);
     void computeOriented(int loopState);
     void computeOptimals(int loopState);
+    void computeOptimal(Structure * structure);
     void computeRadii(int loopState);
     void computeDisparityStatistics(int loopState);
     void filterRadialRange(int loopState);
+    void computeFused(int loopState, bool fusedCheck);
     void filterDisparity(int loopState);
     void exportStructure(std::string path, std::string mode, unsigned int major, unsigned int group);
     void exportPosition(std::string path, std::string mode, unsigned int major);
@@ -21,12 +21,146 @@
 
 #include "framework-frontend.hpp"
 
-FrontendPicture::FrontendPicture(Source * source, cv::Mat mask, Database *database, float const threshold) :
+FrontendPicture::FrontendPicture(Source * source, cv::Mat mask, Database *database, float const threshold, int tiles, unsigned int budget, std::string cacheFolder, int matcherMode, double guidedWindow, int gmsGrid, double gmsRatio, double gateThreshold, bool indexMode) :
 	source(source),
 	mask(mask),
 	database(database),
-    sparseThreshold(threshold)
-{ }
+    sparseThreshold(threshold),
+    sparseTiles(tiles),
+    sparseBudget(budget),
+    sparseAdaptive(threshold),
+    cacheFolder(cacheFolder),
+    matcherMode(matcherMode),
+    guidedWindow(guidedWindow),
+    gmsGrid(gmsGrid),
+    gmsRatio(gmsRatio),
+    gmsHypothesis(0),
+    gateThreshold(gateThreshold),
+    indexMode(indexMode)
+{
+
+    // Adaptive threshold depends on previous frames - cached features would not match the detection
+    if((sparseBudget>0)&&(cacheFolder.empty()==false)){
+        throw std::runtime_error("Error : features cache and budget cannot be used together");
+    }
+
+    // Speculative features extraction on source workers when available - frame order extraction under features budget
+    sparseSpeculative=(sparseBudget==0)&&source->setProcess([this](Viewpoint * viewpoint){ featureExtraction(viewpoint); });
+
+}
+
+FrontendPicture::~FrontendPicture(){
+
+    // Detach speculative features extraction from source workers
+    if(sparseSpeculative==true){
+        source->setProcess(nullptr);
+    }
+
+}
+
+void FrontendPicture::featureExtraction(Viewpoint * viewpoint){
+
+    // Detector threshold - adapted frame to frame under features budget
+    float threshold(sparseBudget>0 ? sparseAdaptive : sparseThreshold);
+
+    // Compute image features and descriptors - through persistent cache if enabled
+    if(cacheFolder.empty()){
+        utilesAKAZEFeatures(viewpoint->getImage(), &mask, viewpoint->getCvFeatures(), viewpoint->getCvDescriptor(), threshold, sparseTiles);
+    }else{
+        utilesAKAZECache(viewpoint->getImage(), &mask, viewpoint->getCvFeatures(), viewpoint->getCvDescriptor(), threshold, sparseTiles, cacheFolder);
+    }
+
+    // Features budget
+    if(sparseBudget>0){
+
+        // Threshold correction toward the detected features target - budget with selection margin
+        double correction(std::sqrt(double(viewpoint->getCvFeatures()->size()+1)/(FRONTEND_BUDGET_MARGIN*sparseBudget)));
+        correction=std::max(0.5,std::min(2.,correction));
+
+        // Update adaptive threshold within bounds of the configured threshold
+        sparseAdaptive=std::max(sparseThreshold/FRONTEND_BUDGET_RANGE,std::min(sparseThreshold*FRONTEND_BUDGET_RANGE,float(sparseAdaptive*correction)));
+
+        // Keep best response features per equal-area bucket
+        utilesFeaturesBudget(viewpoint->getCvFeatures(), viewpoint->getCvDescriptor(), viewpoint->getImage()->size(), sparseBudget);
+
+    }
+
+}
+
+void FrontendPicture::featureBearings(Viewpoint * viewpoint, Viewpoint * reference, std::vector<Eigen::Vector3d> * bearings){
+
+    // Relative orientation of the viewpoint in the reference frame
+    Eigen::Matrix3d orientation(reference->getOrientation()->transpose()*(*viewpoint->getOrientation()));
+
+    // Features bearing in the reference frame
+    bearings->resize(viewpoint->getCvFeatures()->size());
+
+    // Parsing viewpoint features
+    for(unsigned int i(0); i<bearings->size(); i++){
+
+        // Feature pointer
+        Feature * feature(viewpoint->getFeatureFromCvIndex(i));
+
+        // Use structure position when available - rotation only otherwise
+        Structure * structure(feature->getStructure());
+        if((structure!=NULL)&&(structure->getState()!=STRUCTURE_REMOVE)&&(structure->getPosition()->squaredNorm()>0.)){
+            (*bearings)[i]=(reference->getOrientation()->transpose()*((*structure->getPosition())-(*reference->getPosition()))).normalized();
+        }else{
+            (*bearings)[i]=orientation*feature->direction;
+        }
+
+    }
+
+}
+
+void FrontendPicture::featureMatching(Viewpoint * newViewpoint, std::vector<Eigen::Vector3d> * newBearings, Viewpoint * localViewpoint, bool hasPrediction, int * hypothesis, std::vector<cv::DMatch> * matches, std::ostream & logStream){
+
+    // Guided matching on predicted bearings
+    if(hasPrediction==true){
+
+        // Predicted bearings of local features in the new viewpoint frame
+        std::vector<Eigen::Vector3d> localBearings;
+        featureBearings(localViewpoint, newViewpoint, &localBearings);
+
+        // Window restricted matching - exhaustive matching on prediction failure
+        if(utilesGuidedMatcher(
+            newViewpoint->getCvFeatures(),
+            newViewpoint->getCvDescriptor(),
+            newBearings,
+            newViewpoint->getSize(),
+            localViewpoint->getCvFeatures(),
+            localViewpoint->getCvDescriptor(),
+            &localBearings,
+            localViewpoint->getSize(),
+            guidedWindow,
+            matches,
+            gmsGrid,
+            gmsRatio,
+            hypothesis,
+            logStream
+        )==true){
+            return;
+        }
+
+    }
+
+    // Exhaustive matching
+    utilesGMSMatcher(
+        newViewpoint->getCvFeatures(),
+        newViewpoint->getCvDescriptor(),
+        newViewpoint->getSize(),
+        localViewpoint->getCvFeatures(),
+        localViewpoint->getCvDescriptor(),
+        localViewpoint->getSize(),
+        matches,
+        matcherMode,
+        gmsGrid,
+        gmsRatio,
+        hypothesis,
+        logStream
+    );
+
+}
 
 bool FrontendPicture::next() {
 
@@ -34,8 +168,14 @@ bool FrontendPicture::next() {
 
     bool hasViewpoint(false);
 
+    bool hasPrediction(false);
+
     std::vector<cv::DMatch> lastViewpointMatches;
 
+    std::vector<Eigen::Vector3d> newBearings;
+
+    cv::Mat newThumbnail;
+
     // Search source image
     while (hasViewpoint==false) {
 
@@ -47,31 +187,60 @@ bool FrontendPicture::next() {
         // Create viewpoint from source
         newViewpoint = source->next();
 
+        // Motion gate on thumbnails - clearly static frames are rejected before features extraction
+        if(gateThreshold>0.){
+
+            // Compute new image thumbnail
+            newThumbnail=utilesThumbnail(newViewpoint->getImage(), UTILES_GATE_WIDTH);
+
+            // Compute mask thumbnail
+            if(gateMask.empty()&&(mask.empty()==false)){
+                cv::resize(mask, gateMask, newThumbnail.size(), 0, 0, cv::INTER_NEAREST);
+            }
+
+            // Compare with last viewpoint thumbnail
+            if(lastThumbnail.empty()==false){
+
+                // Median angular flow on thumbnails
+                double gateMotion(utilesThumbnailMotion(&lastThumbnail, &newThumbnail, &gateMask));
+
+                // Reject static frame
+                if(gateMotion<gateThreshold){
+                    std::cerr << "Gate : " << gateMotion*180./M_PI << " deg | Rejected" << std::endl;
+                    continue;
+                }
+
+            }
+
+        }
+
         // Assign viewpoint index
         newViewpoint->setIndex(database->viewpoints.size());
 
-        // Compute image features and descriptors
-        utilesAKAZEFeatures(newViewpoint->getImage(), &mask, newViewpoint->getCvFeatures(), newViewpoint->getCvDescriptor(), sparseThreshold);
+        // Compute image features and descriptors - unless speculatively extracted by source workers
+        if((sparseSpeculative==false)||(newViewpoint->getCvFeatures()->empty())){
+            featureExtraction(newViewpoint.get());
+        }
+
+        // Extrapolate the pose of the newViewpoint - guided matching and adaptive window only
+        hasPrediction=((guidedWindow>0.)||database->getAdaptive())&&database->getPrediction(newViewpoint.get());
 
-        // Release viewpoint image
-        newViewpoint->releaseImage();
+        // Compute features bearing in the newViewpoint frame
+        if((hasPrediction==true)&&(guidedWindow>0.)){
+            newBearings.resize(newViewpoint->getCvFeatures()->size());
+            for(unsigned int i(0); i<newBearings.size(); i++){
+                newBearings[i]=utilesDirection((*newViewpoint->getCvFeatures())[i].pt.x, (*newViewpoint->getCvFeatures())[i].pt.y, newViewpoint->width, newViewpoint->height);
+            }
+        }
 
 	    //Check if the image is moving enough using features
 	    if(lastViewpoint){
-		    utilesGMSMatcher(
-			    newViewpoint->getCvFeatures(),
-			    newViewpoint->getCvDescriptor(),
-			    newViewpoint->getImage()->size(),
-			    lastViewpoint->getCvFeatures(),
-			    lastViewpoint->getCvDescriptor(),
-			    lastViewpoint->getImage()->size(),
-			    &lastViewpointMatches
-		    );
+		    featureMatching(newViewpoint.get(), &newBearings, lastViewpoint.get(), hasPrediction&&(guidedWindow>0.), &gmsHypothesis, &lastViewpointMatches, std::cerr);
 		    double score = utilesDetectMotion(
 			    newViewpoint->getCvFeatures(),
 			    lastViewpoint->getCvFeatures(),
 			    &lastViewpointMatches,
-			    lastViewpoint->getImage()->size()
+			    lastViewpoint->getSize()
 		    );
             if(score >= 0.002){ // Old value : 0.0005, 0.002
                 hasViewpoint=true;
@@ -84,49 +253,85 @@ bool FrontendPicture::next() {
 
 	newViewpoint->allocateFeaturesFromCvFeatures();
 
+	//Release viewpoint image - features colors assigned
+	newViewpoint->releaseImage();
+
+	//Keep thumbnail of the accepted viewpoint for the motion gate
+	lastThumbnail = newThumbnail;
+
 	//Extrapolate the position of the newViewpoint
-    newViewpoint->resetFrame();
+    if(hasPrediction==false){
+        newViewpoint->resetFrame();
+    }
 
-	//Get local viewpoints
+	//Get local viewpoints - window adapted on the last pair inliers when the pose is predicted
 	std::vector<std::shared_ptr<Viewpoint>> localViewpoints;
-	database->getLocalViewpoints(newViewpoint->position, &localViewpoints);
+	database->getLocalViewpoints(newViewpoint->position, hasPrediction ? lastViewpointMatches.size() : 0, &localViewpoints);
 
 	uint32_t localViewpointsCount = localViewpoints.size();
 	uint32_t newViewpointFeaturesCount = newViewpoint->getCvFeatures()->size();
 
-	//Match local viewpoints to the new image
-	//profile("gms + correlations");
-	uint32_t *correlations = new uint32_t[newViewpointFeaturesCount*localViewpointsCount]; //-1 => empty
-	memset(correlations, -1, newViewpointFeaturesCount*localViewpointsCount*sizeof(uint32_t));
+	//Match local viewpoints to the new image - one match buffer and log per local viewpoint
+	std::vector<std::vector<cv::DMatch>> localMatches(localViewpointsCount);
+	std::vector<std::stringstream> localLogs(localViewpointsCount);
+
+	//Match all local viewpoints at once through the window descriptors index
+	std::vector<std::vector<cv::DMatch>> indexMatches(localViewpointsCount);
+	if(indexMode){
 
-//		#pragma omp parallel for
+		//Maintain the index on the local viewpoints window
+		std::vector<unsigned int> indexWindow, indexRequest;
+		for(auto & localViewpoint : localViewpoints){
+			indexWindow.push_back(localViewpoint->getIndex());
+			if(localViewpoint != lastViewpoint) indexRequest.push_back(localViewpoint->getIndex());
+		}
+		matcherIndex.retain(&indexWindow);
+		for(auto & localViewpoint : localViewpoints){
+			if(!matcherIndex.hasViewpoint(localViewpoint->getIndex())) matcherIndex.insert(localViewpoint->getIndex(), localViewpoint->getCvDescriptor());
+		}
+
+		//Single pass matching against the requested viewpoints
+		std::vector<std::vector<cv::DMatch>> requestMatches;
+		unsigned long comparisons = matcherIndex.match(newViewpoint->getCvDescriptor(), &indexRequest, &requestMatches);
+		std::cerr << "Index : " << comparisons << " comparisons | Fallback : " << matcherIndex.fallback << " queries | Viewpoints : " << indexRequest.size() << std::endl;
+
+		//Dispatch matches in local viewpoints order
+		for(uint32_t localViewpointIdx = 0, requestIdx = 0; localViewpointIdx < localViewpointsCount; localViewpointIdx++){
+			if(localViewpoints[localViewpointIdx] != lastViewpoint) indexMatches[localViewpointIdx].swap(requestMatches[requestIdx++]);
+		}
+
+	}
+
+	#pragma omp parallel for schedule(dynamic)
 	for(uint32_t localViewpointIdx = 0; localViewpointIdx < localViewpointsCount; localViewpointIdx++){
 		auto localViewpoint = localViewpoints[localViewpointIdx];
-		if(localViewpoint == lastViewpoint){ //Reuse previously processed matches
-			for(auto match : lastViewpointMatches){
-				correlations[localViewpointIdx + match.queryIdx*localViewpointsCount] = match.trainIdx;
-			}
-		} else {
-			std::vector<cv::DMatch> matches;
-			utilesGMSMatcher(
-				newViewpoint->getCvFeatures(),
-				newViewpoint->getCvDescriptor(),
-				newViewpoint->getImage()->size(),
-				localViewpoint->getCvFeatures(),
-				localViewpoint->getCvDescriptor(),
-				localViewpoint->getImage()->size(),
-				&matches
-			);
-
-			for(auto match : matches){
-				correlations[localViewpointIdx + match.queryIdx*localViewpointsCount] = match.trainIdx;
+		if(localViewpoint != lastViewpoint){ //Previously processed matches are reused
+			int localHypothesis(gmsHypothesis); //Last pair winner as prior
+			if(indexMode){
+				localLogs[localViewpointIdx] << "Feat 1 : " << newViewpointFeaturesCount << " | Feat 2 : " << localViewpoint->getCvFeatures()->size() << " | Match : " << indexMatches[localViewpointIdx].size();
+				utilesGMSFilter(newViewpoint->getCvFeatures(), newViewpoint->getSize(), localViewpoint->getCvFeatures(), localViewpoint->getSize(), &indexMatches[localViewpointIdx], &localMatches[localViewpointIdx], gmsGrid, gmsRatio, &localHypothesis, localLogs[localViewpointIdx]);
+				localLogs[localViewpointIdx] << " | Filter : " << localMatches[localViewpointIdx].size() << std::endl;
+			}else{
+				featureMatching(newViewpoint.get(), &newBearings, localViewpoint.get(), hasPrediction&&(guidedWindow>0.), &localHypothesis, &localMatches[localViewpointIdx], localLogs[localViewpointIdx]);
 			}
 		}
 	}
 
+	//Display matching summaries in local viewpoints order
+	for(auto & localLog : localLogs){
+		std::cerr << localLog.str();
+	}
+
+	//Build sparse correlations in local viewpoints order
+	std::vector<std::vector<cv::DMatch>*> correlationMatches(localViewpointsCount);
+	for(uint32_t localViewpointIdx = 0; localViewpointIdx < localViewpointsCount; localViewpointIdx++){
+		correlationMatches[localViewpointIdx] = localViewpoints[localViewpointIdx] == lastViewpoint ? &lastViewpointMatches : &localMatches[localViewpointIdx];
+	}
+	AggregateCorrelation correlation;
+	correlation.build(newViewpointFeaturesCount, &correlationMatches);
+
 	//Integrate the new image features into the structure
-	database->aggregate(&localViewpoints, newViewpoint.get(), correlations);
-	delete[] correlations;
+	database->aggregate(&localViewpoints, newViewpoint.get(), &correlation);
 
 	lastViewpoint = newViewpoint;
 
@@ -229,3 +434,239 @@ bool FrontendDense::next() {
     database->addViewpoint(newViewpoint);
     return true;
 }
+
+FrontendTrack::FrontendTrack(Source * source, cv::Mat mask, Database *database, float const threshold, int tiles, int period, int cell, int window, int levels, double gateThreshold) :
+    source(source),
+    mask(mask),
+    database(database),
+    trackThreshold(threshold),
+    trackTiles(tiles),
+    trackPeriod(period),
+    trackCell(cell),
+    trackWindow(window),
+    trackLevels(levels),
+    trackFrame(0),
+    gateThreshold(gateThreshold)
+{
+
+    // Longitude wrap margin - covers the largest displacement the pyramid can follow
+    trackMargin=(trackWindow/2+1)<<trackLevels;
+
+}
+
+void FrontendTrack::trackPyramid(Viewpoint * viewpoint, std::vector<cv::Mat> * pyramid){
+
+    // Grayscale image
+    cv::Mat gray;
+    cv::cvtColor(*viewpoint->getImage(), gray, cv::COLOR_BGR2GRAY);
+
+    // Wrap image in longitude - tracks can cross the equirectangular seam
+    cv::Mat wrap;
+    cv::copyMakeBorder(gray, wrap, 0, 0, trackMargin, trackMargin, cv::BORDER_WRAP);
+
+    // Build pyramid once per image - shared by forward and backward tracking
+    cv::buildOpticalFlowPyramid(wrap, *pyramid, cv::Size(trackWindow, trackWindow), trackLevels);
+
+}
+
+void FrontendTrack::trackFeature(Viewpoint * viewpoint, Structure * structure, float x, float y){
+
+    // Instance feature
+    auto feature = new Feature();
+
+    // Initialise feature
+    feature->setFeature(x, y, viewpoint->width, viewpoint->height);
+    feature->setRadius(1., 0.);
+    feature->setViewpointPtr(viewpoint);
+    feature->setStructurePtr(NULL);
+    feature->setColor(viewpoint->getImage()->at<cv::Vec3b>(y, x));
+
+    // Push feature
+    viewpoint->addFeature(feature);
+
+    // Extend track
+    if(structure){
+        structure->addFeature(feature);
+    }
+
+}
+
+unsigned int FrontendTrack::trackReplenish(Viewpoint * viewpoint, cv::Mat * occupancy){
+
+    // Detected features
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat descriptor;
+
+    // Replenished features count
+    unsigned int count(0);
+
+    // Detect features on the whole image
+    utilesAKAZEFeatures(viewpoint->getImage(), &mask, &keypoints, &descriptor, trackThreshold, trackTiles);
+
+    // Strongest features first
+    std::sort(keypoints.begin(), keypoints.end(), [](const cv::KeyPoint & a, const cv::KeyPoint & b){ return a.response > b.response; });
+
+    // Seed one new feature per empty cell
+    for(auto & keypoint : keypoints){
+        uint8_t & cell(occupancy->at<uint8_t>(int(keypoint.pt.y)/trackCell, int(keypoint.pt.x)/trackCell));
+        if(cell==0){
+            cell=1;
+            trackFeature(viewpoint, NULL, keypoint.pt.x, keypoint.pt.y);
+            count++;
+        }
+    }
+
+    // Return replenished count
+    return count;
+
+}
+
+bool FrontendTrack::next() {
+
+    std::shared_ptr<Viewpoint> newViewpoint;
+
+    std::vector<cv::Mat> newPyramid;
+
+    cv::Mat occupancy;
+
+    // Tracks to extend - last feature and position in the new image
+    std::vector<Feature *> trackLast;
+    std::vector<cv::Point2f> trackNew;
+
+    bool hasViewpoint(false);
+
+    // Search source image
+    while (hasViewpoint==false) {
+
+        // Check image list exhaust
+        if(source->hasNext()==false){
+            return false;
+        }
+
+        // Create viewpoint from source
+        newViewpoint = source->next();
+
+        // Build new image pyramid
+        trackPyramid(newViewpoint.get(), &newPyramid);
+
+        // Occupancy cells covered by the mask
+        if(cellMask.empty()){
+            cellMask=cv::Mat::zeros((newViewpoint->height+trackCell-1)/trackCell, (newViewpoint->width+trackCell-1)/trackCell, CV_8UC1);
+            for(int y(0); y<cellMask.rows; y++){
+                for(int x(0); x<cellMask.cols; x++){
+                    int cx(std::min(x*trackCell+trackCell/2, newViewpoint->width-1));
+                    int cy(std::min(y*trackCell+trackCell/2, newViewpoint->height-1));
+                    cellMask.at<uint8_t>(y, x)=(mask.empty()||(mask.at<uint8_t>(cy, cx)!=0)) ? 1 : 0;
+                }
+            }
+        }
+
+        // Reset occupancy and tracks
+        occupancy=cv::Mat::zeros(cellMask.rows, cellMask.cols, CV_8UC1);
+        trackLast.clear();
+        trackNew.clear();
+
+        // First image - nothing to propagate
+        if(!lastViewpoint){
+            hasViewpoint=true;
+            continue;
+        }
+
+        // Last image features positions on the wrapped image
+        std::vector<cv::Point2f> pointLast, pointNew, pointBack;
+        for(auto lastFeature : lastViewpoint->features){
+            pointLast.push_back(cv::Point2f(lastFeature->position.x()+trackMargin, lastFeature->position.y()));
+        }
+
+        // Forward and backward pyramidal Lucas-Kanade
+        std::vector<unsigned char> status, statusBack;
+        std::vector<float> error;
+        if(pointLast.empty()==false){
+            cv::calcOpticalFlowPyrLK(lastPyramid, newPyramid, pointLast, pointNew, status, error, cv::Size(trackWindow, trackWindow), trackLevels);
+            cv::calcOpticalFlowPyrLK(newPyramid, lastPyramid, pointNew, pointBack, statusBack, error, cv::Size(trackWindow, trackWindow), trackLevels);
+        }
+
+        // Angular displacements of kept tracks
+        std::vector<double> displacement;
+
+        // Keep consistent tracks - one per occupancy cell
+        for(unsigned int i(0); i<pointLast.size(); i++){
+
+            // Tracking status and forward-backward consistency
+            if((status[i]==0)||(statusBack[i]==0)) continue;
+            if(cv::norm(pointBack[i]-pointLast[i])>FRONTEND_TRACK_BACKWARD) continue;
+
+            // Unwrap position in longitude
+            float x(std::fmod(pointNew[i].x-trackMargin+newViewpoint->width, float(newViewpoint->width)));
+            float y(pointNew[i].y);
+
+            // Image and mask boundaries
+            if((x<0)||(x>=newViewpoint->width)||(y<0)||(y>=newViewpoint->height)) continue;
+            if((mask.empty()==false)&&(mask.at<uint8_t>(y, x)==0)) continue;
+
+            // Converging tracks
+            uint8_t & cell(occupancy.at<uint8_t>(int(y)/trackCell, int(x)/trackCell));
+            if(cell!=0) continue;
+            cell=1;
+
+            // Keep track
+            trackLast.push_back(lastViewpoint->features[i]);
+            trackNew.push_back(cv::Point2f(x, y));
+
+            // Track angular displacement
+            Eigen::Vector3d p1(utilesDirection(lastViewpoint->features[i]->position.x(), lastViewpoint->features[i]->position.y(), newViewpoint->width, newViewpoint->height));
+            Eigen::Vector3d p2(utilesDirection(x, y, newViewpoint->width, newViewpoint->height));
+            displacement.push_back(std::acos(std::max(-1.,std::min(1.,p1.dot(p2)))));
+
+        }
+
+        // Reject static frame - tracks keep following the last viewpoint
+        if((gateThreshold>0.)&&(displacement.size()>0)){
+            std::nth_element(displacement.begin(), displacement.begin()+displacement.size()/2, displacement.end());
+            if(displacement[displacement.size()/2]<gateThreshold){
+                std::cerr << "Gate : " << displacement[displacement.size()/2]*180./M_PI << " deg | Rejected" << std::endl;
+                continue;
+            }
+        }
+
+        hasViewpoint=true;
+
+    }
+
+    // Assign viewpoint index
+    newViewpoint->setIndex(database->viewpoints.size());
+
+    // Extend tracks - last feature joins a new structure when not already tracked
+    for(unsigned int i(0); i<trackLast.size(); i++){
+        if(trackLast[i]->structure==NULL){
+            database->addStructure()->addFeature(trackLast[i]);
+        }
+        trackFeature(newViewpoint.get(), trackLast[i]->structure, trackNew[i].x, trackNew[i].y);
+    }
+
+    // Occupied cells ratio
+    double coverage(double(cv::countNonZero(occupancy))/std::max(1,cv::countNonZero(cellMask)));
+
+    // Replenish tracks in sparse regions, or periodically
+    unsigned int replenish(0);
+    trackFrame++;
+    if((coverage<FRONTEND_TRACK_COVERAGE)||((trackPeriod>0)&&(trackFrame>=trackPeriod))){
+        replenish=trackReplenish(newViewpoint.get(), &occupancy);
+        trackFrame=0;
+    }
+
+    // Display tracking summary
+    std::cerr << "Track : " << trackLast.size() << " | Lost : " << (lastViewpoint ? lastViewpoint->features.size()-trackLast.size() : 0) << " | Coverage : " << coverage << " | Replenish : " << replenish << std::endl;
+
+    // Release viewpoint image - features colors assigned
+    newViewpoint->releaseImage();
+
+    // Keep pyramid for next propagation
+    lastPyramid.swap(newPyramid);
+
+    lastViewpoint = newViewpoint;
+
+    database->addViewpoint(newViewpoint);
+    return true;
+}
+
@@ -30,6 +30,14 @@
 #include "framework-source.hpp"
 #include "framework-utiles.hpp"
 
+// Features budget - detected features target over budget and adaptive threshold range
+#define FRONTEND_BUDGET_MARGIN ( 1.5 )
+#define FRONTEND_BUDGET_RANGE  ( 100.f )
+
+// Track propagation - forward-backward tolerance in pixels and occupied cells ratio triggering replenishment
+#define FRONTEND_TRACK_BACKWARD ( 1.0 )
+#define FRONTEND_TRACK_COVERAGE ( 0.6 )
+
 // Module object
 class Frontend{
 
@@ -48,13 +56,29 @@ private:
 	std::shared_ptr<Viewpoint> lastViewpoint;
 	cv::Mat mask;
 	Database *database;
-	double scale;
     float sparseThreshold;
+    int sparseTiles;
+    unsigned int sparseBudget;
+    float sparseAdaptive;
+    bool sparseSpeculative;
+    std::string cacheFolder;
+    int matcherMode;
+    double guidedWindow;
+    int gmsGrid;
+    double gmsRatio;
+    int gmsHypothesis;
+    double gateThreshold;
+    cv::Mat gateMask;
+    cv::Mat lastThumbnail;
+    bool indexMode;
+    MatcherIndex matcherIndex;
 
 public:
-	void featureExtraction();
-    FrontendPicture(Source * source, cv::Mat mask, Database *database, float const threshold);
-	virtual ~FrontendPicture(){}
+	void featureExtraction(Viewpoint * viewpoint);
+    void featureBearings(Viewpoint * viewpoint, Viewpoint * reference, std::vector<Eigen::Vector3d> * bearings);
+    void featureMatching(Viewpoint * newViewpoint, std::vector<Eigen::Vector3d> * newBearings, Viewpoint * localViewpoint, bool hasPrediction, int * hypothesis, std::vector<cv::DMatch> * matches, std::ostream & logStream);
+    FrontendPicture(Source * source, cv::Mat mask, Database *database, float const threshold, int tiles, unsigned int budget, std::string cacheFolder, int matcherMode, double guidedWindow, int gmsGrid, double gmsRatio, double gateThreshold, bool indexMode);
+	virtual ~FrontendPicture();
 	virtual bool next();
 
 };
@@ -75,3 +99,32 @@ public:
 
 };
 
+// Module derived object
+class FrontendTrack : public Frontend{
+
+private:
+    Source * source;
+    std::shared_ptr<Viewpoint> lastViewpoint;
+    cv::Mat mask;
+    Database *database;
+    float trackThreshold;
+    int trackTiles;
+    int trackPeriod;
+    int trackCell;
+    int trackWindow;
+    int trackLevels;
+    int trackMargin;
+    int trackFrame;
+    double gateThreshold;
+    cv::Mat cellMask;
+    std::vector<cv::Mat> lastPyramid;
+
+public:
+    FrontendTrack(Source * source, cv::Mat mask, Database *database, float const threshold, int tiles, int period, int cell, int window, int levels, double gateThreshold);
+    virtual ~FrontendTrack(){}
+    void trackPyramid(Viewpoint * viewpoint, std::vector<cv::Mat> * pyramid);
+    void trackFeature(Viewpoint * viewpoint, Structure * structure, float x, float y);
+    unsigned int trackReplenish(Viewpoint * viewpoint, cv::Mat * occupancy);
+    virtual bool next();
+
+};
@@ -0,0 +1,652 @@
+/*
+ *  sfs-framework
+ *
+ *      Nils Hamel - nils.hamel@bluewin.ch
+ *      Charles Papon - charles.papon.90@gmail.com
+ *      Copyright (c) 2019-2020 DHLAB, EPFL & HES-SO Valais-Wallis
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framework-matcher.hpp"
+
+//
+//  Distance tiles kernels
+//
+//  Each kernel computes the Hamming distances between a tile of query and
+//  a tile of train descriptors and updates both the best train candidate of
+//  each query and the best query candidate of each train descriptor. Best
+//  candidates are stored as (distance << 32 | index) so that a single min
+//  keeps the smallest distance and, on ties, the smallest index.
+//
+
+static void matcherTileScalar(uint64_t const * p1, uint64_t const * p2, size_t words, uint32_t q0, uint32_t q1, uint32_t t0, uint32_t t1, uint64_t * rowBest, uint64_t * colBest){
+
+    // Parsing tile
+    for(uint32_t q(q0); q<q1; q++){
+        uint64_t const * a(p1+q*words);
+        uint64_t best(rowBest[q]);
+        for(uint32_t t(t0); t<t1; t++){
+            uint64_t const * b(p2+t*words);
+            uint64_t distance(0);
+            for(size_t k(0); k<words; k++){
+                distance+=__builtin_popcountll(a[k]^b[k]);
+            }
+            best=std::min(best,(distance<<32)|t);
+            colBest[t]=std::min(colBest[t],(distance<<32)|q);
+        }
+        rowBest[q]=best;
+    }
+
+}
+
+__attribute__((target("popcnt")))
+static void matcherTilePopcnt(uint64_t const * p1, uint64_t const * p2, size_t words, uint32_t q0, uint32_t q1, uint32_t t0, uint32_t t1, uint64_t * rowBest, uint64_t * colBest){
+
+    // Parsing tile - hardware scalar popcount
+    for(uint32_t q(q0); q<q1; q++){
+        uint64_t const * a(p1+q*words);
+        uint64_t best(rowBest[q]);
+        for(uint32_t t(t0); t<t1; t++){
+            uint64_t const * b(p2+t*words);
+            uint64_t distance(0);
+            for(size_t k(0); k<words; k++){
+                distance+=_mm_popcnt_u64(a[k]^b[k]);
+            }
+            best=std::min(best,(distance<<32)|t);
+            colBest[t]=std::min(colBest[t],(distance<<32)|q);
+        }
+        rowBest[q]=best;
+    }
+
+}
+
+__attribute__((target("avx2")))
+static void matcherTileAVX2(uint64_t const * p1, uint64_t const * p2, size_t words, uint32_t q0, uint32_t q1, uint32_t t0, uint32_t t1, uint64_t * rowBest, uint64_t * colBest){
+
+    // Nibble population count table
+    __m256i const table(_mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4));
+    __m256i const nibble(_mm256_set1_epi8(0x0f));
+
+    // Parsing tile - 32 bytes lanes, words is a multiple of 4
+    for(uint32_t q(q0); q<q1; q++){
+        uint64_t const * a(p1+q*words);
+        uint64_t best(rowBest[q]);
+        for(uint32_t t(t0); t<t1; t++){
+            uint64_t const * b(p2+t*words);
+            __m256i accum(_mm256_setzero_si256());
+            for(size_t k(0); k<words; k+=4){
+                __m256i value(_mm256_xor_si256(_mm256_loadu_si256((__m256i const *)(a+k)),_mm256_loadu_si256((__m256i const *)(b+k))));
+                __m256i count(_mm256_add_epi8(
+                    _mm256_shuffle_epi8(table,_mm256_and_si256(value,nibble)),
+                    _mm256_shuffle_epi8(table,_mm256_and_si256(_mm256_srli_epi16(value,4),nibble))
+                ));
+                accum=_mm256_add_epi64(accum,_mm256_sad_epu8(count,_mm256_setzero_si256()));
+            }
+            uint64_t distance(_mm256_extract_epi64(accum,0)+_mm256_extract_epi64(accum,1)+_mm256_extract_epi64(accum,2)+_mm256_extract_epi64(accum,3));
+            best=std::min(best,(distance<<32)|t);
+            colBest[t]=std::min(colBest[t],(distance<<32)|q);
+        }
+        rowBest[q]=best;
+    }
+
+}
+
+#if defined(__GNUC__) && ( __GNUC__ >= 8 )
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static void matcherTileAVX512(uint64_t const * p1, uint64_t const * p2, size_t words, uint32_t q0, uint32_t q1, uint32_t t0, uint32_t t1, uint64_t * rowBest, uint64_t * colBest){
+
+    // Parsing tile - 64 bytes lanes, words is a multiple of 8
+    for(uint32_t q(q0); q<q1; q++){
+        uint64_t const * a(p1+q*words);
+        uint64_t best(rowBest[q]);
+        for(uint32_t t(t0); t<t1; t++){
+            uint64_t const * b(p2+t*words);
+            __m512i accum(_mm512_setzero_si512());
+            for(size_t k(0); k<words; k+=8){
+                accum=_mm512_add_epi64(accum,_mm512_popcnt_epi64(_mm512_xor_si512(_mm512_loadu_si512(a+k),_mm512_loadu_si512(b+k))));
+            }
+            uint64_t distance(_mm512_reduce_add_epi64(accum));
+            best=std::min(best,(distance<<32)|t);
+            colBest[t]=std::min(colBest[t],(distance<<32)|q);
+        }
+        rowBest[q]=best;
+    }
+
+}
+#endif
+
+//
+//  Matcher
+//
+
+int matcherMode(std::string modeName){
+
+    // Convert matching mode name
+    if(modeName=="brute"){
+        return MATCHER_MODE_BRUTE;
+    }else
+    if(modeName=="hamming"){
+        return MATCHER_MODE_HAMMING;
+    }else
+    if(modeName=="benchmark"){
+        return MATCHER_MODE_BENCHMARK;
+    }
+
+    // Send critical message
+    throw std::runtime_error("Error : unknown matcher mode " + modeName);
+
+}
+
+size_t matcherPack(cv::Mat * desc, std::vector<uint64_t> * packed){
+
+    // Padded descriptor size in 64 bits words - multiple of 64 bytes
+    size_t words(((desc->cols*desc->elemSize()+63)/64)*8);
+
+    // Copy descriptors in zero padded rows
+    packed->assign(desc->rows*words, 0);
+    for(int i(0); i<desc->rows; i++){
+        memcpy(packed->data()+i*words, desc->ptr<unsigned char>(i), desc->cols*desc->elemSize());
+    }
+
+    // Return padded descriptor size
+    return words;
+
+}
+
+void matcherCrossCheck(uint64_t const * p1, uint32_t n1, uint64_t const * p2, uint32_t n2, size_t words, std::vector<cv::DMatch> * matches){
+
+    // Tile kernel
+    void (*matcherTile)(uint64_t const *, uint64_t const *, size_t, uint32_t, uint32_t, uint32_t, uint32_t, uint64_t *, uint64_t *)(matcherTileScalar);
+
+    // Best candidates of each query and train descriptor
+    std::vector<uint64_t> rowBest(n1, UINT64_MAX);
+    std::vector<uint64_t> colBest(n2, UINT64_MAX);
+
+    // Select kernel according to processor capabilities
+#if defined(__GNUC__) && ( __GNUC__ >= 8 )
+    if(__builtin_cpu_supports("avx512vpopcntdq")){
+        matcherTile=matcherTileAVX512;
+    }else
+#endif
+    if(__builtin_cpu_supports("avx2")){
+        matcherTile=matcherTileAVX2;
+    }else
+    if(__builtin_cpu_supports("popcnt")){
+        matcherTile=matcherTilePopcnt;
+    }
+
+    // Parsing query tiles - each thread keeps its own train candidates
+    # pragma omp parallel
+    {
+
+        // Thread train candidates
+        std::vector<uint64_t> threadBest(n2, UINT64_MAX);
+
+        # pragma omp for schedule(dynamic)
+        for(uint32_t q0=0; q0<n1; q0+=MATCHER_TILE_QUERY){
+            for(uint32_t t0(0); t0<n2; t0+=MATCHER_TILE_TRAIN){
+                matcherTile(p1, p2, words, q0, std::min(q0+MATCHER_TILE_QUERY,n1), t0, std::min(t0+MATCHER_TILE_TRAIN,n2), rowBest.data(), threadBest.data());
+            }
+        }
+
+        // Reduce train candidates
+        # pragma omp critical
+        for(uint32_t t(0); t<n2; t++){
+            colBest[t]=std::min(colBest[t],threadBest[t]);
+        }
+
+    }
+
+    // Keep mutual best candidates
+    matches->clear();
+    for(uint32_t q(0); q<n1; q++){
+        uint32_t t(rowBest[q]&0xFFFFFFFF);
+        if((rowBest[q]!=UINT64_MAX)&&((colBest[t]&0xFFFFFFFF)==q)){
+            matches->push_back(cv::DMatch(q, t, float(rowBest[q]>>32)));
+        }
+    }
+
+}
+
+void matcherHamming(cv::Mat * d1, cv::Mat * d2, std::vector<cv::DMatch> * matches){
+
+    // Padded descriptors
+    std::vector<uint64_t> p1, p2;
+
+    // Check descriptors
+    if((d1->rows==0)||(d2->rows==0)){
+        matches->clear();
+        return;
+    }
+
+    // Pack descriptors
+    size_t words(matcherPack(d1, &p1));
+    matcherPack(d2, &p2);
+
+    // Compute cross-checked matches
+    matcherCrossCheck(p1.data(), d1->rows, p2.data(), d2->rows, words, matches);
+
+}
+
+unsigned long matcherGuided(cv::Mat * d1, std::vector<Eigen::Vector3d> * b1, cv::Mat * d2, std::vector<Eigen::Vector3d> * b2, double window, std::vector<cv::DMatch> * matches){
+
+    // Padded descriptors
+    std::vector<uint64_t> p1, p2;
+
+    // Descriptors count
+    uint32_t n1(d1->rows), n2(d2->rows);
+
+    // Candidate comparisons count
+    unsigned long comparisons(0);
+
+    // Check descriptors
+    matches->clear();
+    if((n1==0)||(n2==0)){
+        return 0;
+    }
+
+    // Pack descriptors
+    size_t words(matcherPack(d1, &p1));
+    matcherPack(d2, &p2);
+
+    // Spherical grid - cells of the window size on latitude and longitude
+    int gridLat(std::max(1,int(std::ceil(M_PI/window))));
+    int gridLon(std::max(1,int(std::ceil(2.*M_PI/window))));
+    double cellLat(M_PI/gridLat);
+    double cellLon(2.*M_PI/gridLon);
+
+    // Window angular threshold
+    double windowCos(std::cos(window));
+
+    // Bucket train bearings on the grid - cell offsets and sorted train indexes
+    std::vector<uint32_t> cellStart(gridLat*gridLon+1, 0);
+    std::vector<uint32_t> cellIndex(n2);
+    std::vector<int> cellOf(n2);
+    for(uint32_t t(0); t<n2; t++){
+        Eigen::Vector3d const & b((*b2)[t]);
+        int lat(std::min(gridLat-1,int((std::asin(std::max(-1.,std::min(1.,b(2))))+M_PI/2.)/cellLat)));
+        int lon(std::min(gridLon-1,int((std::atan2(b(1),b(0))+M_PI)/cellLon)));
+        cellOf[t]=lat*gridLon+lon;
+        cellStart[cellOf[t]+1]++;
+    }
+    for(int c(0); c<gridLat*gridLon; c++){
+        cellStart[c+1]+=cellStart[c];
+    }
+    std::vector<uint32_t> cellFill(cellStart.begin(), cellStart.end()-1);
+    for(uint32_t t(0); t<n2; t++){
+        cellIndex[cellFill[cellOf[t]]++]=t;
+    }
+
+    // Best candidates of each query and train descriptor
+    std::vector<uint64_t> rowBest(n1, UINT64_MAX);
+    std::vector<uint64_t> colBest(n2, UINT64_MAX);
+
+    // Parsing queries - each thread keeps its own train candidates
+    # pragma omp parallel reduction(+:comparisons)
+    {
+
+        // Thread train candidates
+        std::vector<uint64_t> threadBest(n2, UINT64_MAX);
+
+        # pragma omp for schedule(dynamic,256)
+        for(uint32_t q=0; q<n1; q++){
+
+            // Query bearing and coordinates
+            Eigen::Vector3d const & b((*b1)[q]);
+            double phi(std::asin(std::max(-1.,std::min(1.,b(2)))));
+            double lambda(std::atan2(b(1),b(0))+M_PI);
+
+            // Latitude cells range covered by the window
+            int latLow (std::max(0,int((phi-window+M_PI/2.)/cellLat)));
+            int latHigh(std::min(gridLat-1,int((phi+window+M_PI/2.)/cellLat)));
+
+            // Longitude cells range covered by the window - full turn close to poles
+            double extent(std::cos(std::min(M_PI/2.,std::fabs(phi)+window)));
+            int lonSpan(extent>window/M_PI ? int(std::ceil((window/extent)/cellLon)) : gridLon);
+            int lonCenter(std::min(gridLon-1,int(lambda/cellLon)));
+            if(2*lonSpan+1>=gridLon){
+                lonSpan=-1;
+            }
+
+            // Query candidate
+            uint64_t const * a(p1.data()+q*words);
+            uint64_t best(UINT64_MAX);
+
+            // Parsing covered cells - longitude wraps around
+            for(int lat(latLow); lat<=latHigh; lat++){
+                for(int l(lonSpan<0 ? 0 : -lonSpan); l<=(lonSpan<0 ? gridLon-1 : lonSpan); l++){
+                    int cell(lat*gridLon+(lonSpan<0 ? l : (lonCenter+l+gridLon)%gridLon));
+                    for(uint32_t k(cellStart[cell]); k<cellStart[cell+1]; k++){
+                        uint32_t t(cellIndex[k]);
+
+                        // Angular window condition
+                        if(b.dot((*b2)[t])<windowCos){
+                            continue;
+                        }
+
+                        // Hamming distance
+                        uint64_t const * c(p2.data()+t*words);
+                        uint64_t distance(0);
+                        for(size_t w(0); w<words; w++){
+                            distance+=__builtin_popcountll(a[w]^c[w]);
+                        }
+                        comparisons++;
+
+                        // Update candidates
+                        best=std::min(best,(distance<<32)|t);
+                        threadBest[t]=std::min(threadBest[t],(distance<<32)|q);
+
+                    }
+                }
+            }
+
+            // Assign query candidate
+            rowBest[q]=best;
+
+        }
+
+        // Reduce train candidates
+        # pragma omp critical
+        for(uint32_t t(0); t<n2; t++){
+            colBest[t]=std::min(colBest[t],threadBest[t]);
+        }
+
+    }
+
+    // Keep mutual best candidates
+    for(uint32_t q(0); q<n1; q++){
+        uint32_t t(rowBest[q]&0xFFFFFFFF);
+        if((rowBest[q]!=UINT64_MAX)&&((colBest[t]&0xFFFFFFFF)==q)){
+            matches->push_back(cv::DMatch(q, t, float(rowBest[q]>>32)));
+        }
+    }
+
+    // Return candidate comparisons count
+    return comparisons;
+
+}
+
+bool MatcherIndex::hasViewpoint(unsigned int viewpoint){
+
+    // Check viewpoint presence
+    return packed.count(viewpoint)>0;
+
+}
+
+void MatcherIndex::insert(unsigned int viewpoint, cv::Mat * desc){
+
+    // Padded descriptors
+    std::vector<uint64_t> & pack(packed[viewpoint]);
+
+    // Pack viewpoint descriptors
+    words=matcherPack(desc, &pack);
+    counts[viewpoint]=desc->rows;
+
+    // Chunks count - padding is not indexed
+    size_t chunks((desc->cols*desc->elemSize()*8)/MATCHER_INDEX_CHUNK);
+    tables.resize(chunks);
+
+    // Parsing chunks
+    for(size_t c(0); c<chunks; c++){
+
+        // Chunk keys of the viewpoint
+        std::vector<uint64_t> keys(desc->rows);
+        for(int i(0); i<desc->rows; i++){
+            uint64_t value((pack[i*words+c/4]>>((c%4)*MATCHER_INDEX_CHUNK))&0xFFFF);
+            keys[i]=(value<<48)|(uint64_t(viewpoint&0xFFFFFF)<<24)|uint64_t(i);
+        }
+        std::sort(keys.begin(), keys.end());
+
+        // Merge keys in chunk table
+        size_t middle(tables[c].size());
+        tables[c].insert(tables[c].end(), keys.begin(), keys.end());
+        std::inplace_merge(tables[c].begin(), tables[c].begin()+middle, tables[c].end());
+
+    }
+
+}
+
+void MatcherIndex::remove(unsigned int viewpoint){
+
+    // Remove viewpoint keys from chunk tables
+    for(auto & table: tables){
+        table.erase(std::remove_if(table.begin(), table.end(), [viewpoint](uint64_t key){
+            return ((key>>24)&0xFFFFFF)==(viewpoint&0xFFFFFF);
+        }), table.end());
+    }
+
+    // Remove viewpoint descriptors
+    packed.erase(viewpoint);
+    counts.erase(viewpoint);
+
+}
+
+void MatcherIndex::retain(std::vector<unsigned int> * viewpoints){
+
+    // Viewpoints leaving the window
+    std::vector<unsigned int> leaving;
+    for(auto & entry: packed){
+        if(std::find(viewpoints->begin(), viewpoints->end(), entry.first)==viewpoints->end()){
+            leaving.push_back(entry.first);
+        }
+    }
+
+    // Remove leaving viewpoints
+    for(auto & viewpoint: leaving){
+        remove(viewpoint);
+    }
+
+}
+
+unsigned long MatcherIndex::match(cv::Mat * desc, std::vector<unsigned int> * viewpoints, std::vector<std::vector<cv::DMatch>> * matches){
+
+    // Padded query descriptors
+    std::vector<uint64_t> query;
+
+    // Candidate comparisons count
+    unsigned long comparisons(0);
+
+    // Query descriptors count
+    uint32_t n1(desc->rows);
+
+    // Viewpoints slots in the request order
+    std::vector<uint64_t> slots(viewpoints->size());
+    std::vector<uint64_t const *> trains(viewpoints->size());
+    std::vector<uint32_t> sizes(viewpoints->size());
+    for(unsigned int s(0); s<viewpoints->size(); s++){
+        slots[s]=(*viewpoints)[s]&0xFFFFFF;
+        trains[s]=packed[(*viewpoints)[s]].data();
+        sizes[s]=counts[(*viewpoints)[s]];
+    }
+
+    // Reset matches
+    fallback=0;
+    matches->assign(viewpoints->size(), std::vector<cv::DMatch>());
+    if((n1==0)||(packed.empty())){
+        return 0;
+    }
+
+    // Pack query descriptors
+    matcherPack(desc, &query);
+
+    // Chunk probing masks - values within the probing radius
+    std::vector<uint64_t> probes;
+    for(uint64_t mask(0); mask<(uint64_t(1)<<MATCHER_INDEX_CHUNK); mask++){
+        if(__builtin_popcountll(mask)<=MATCHER_INDEX_RADIUS){
+            probes.push_back(mask);
+        }
+    }
+
+    // Guaranteed distance - a closer descriptor has a chunk within the probing radius
+    uint64_t bound(tables.size()*(MATCHER_INDEX_RADIUS+1)-1);
+
+    // Best candidates of each query and train descriptor per viewpoint
+    std::vector<uint64_t> rowBest(n1*slots.size(), UINT64_MAX);
+    std::vector<std::vector<uint64_t>> colBest(slots.size());
+    for(unsigned int s(0); s<slots.size(); s++){
+        colBest[s].assign(sizes[s], UINT64_MAX);
+    }
+
+    // Parsing queries - each thread keeps its own train candidates
+    # pragma omp parallel reduction(+:comparisons)
+    {
+
+        // Thread train candidates and visit stamps - a candidate found in several chunks is compared once
+        std::vector<std::vector<uint64_t>> threadBest(colBest);
+        std::vector<std::vector<uint32_t>> threadStamp(slots.size());
+        for(unsigned int s(0); s<slots.size(); s++){
+            threadStamp[s].assign(sizes[s], 0);
+        }
+
+        # pragma omp for schedule(dynamic,256)
+        for(uint32_t q=0; q<n1; q++){
+
+            // Query descriptor
+            uint64_t const * a(query.data()+q*words);
+
+            // Parsing chunks - a descriptor closer than the bound has a chunk within the probing radius
+            for(size_t c(0); c<tables.size(); c++){
+
+                // Query chunk value
+                uint64_t value((a[c/4]>>((c%4)*MATCHER_INDEX_CHUNK))&0xFFFF);
+
+                // Parsing probed chunk values
+                for(auto & probe: probes){
+
+                    // Keys sharing the probed chunk value
+                    uint64_t probed(value^probe);
+                    auto low(std::lower_bound(tables[c].begin(), tables[c].end(), probed<<48));
+                    auto high(std::lower_bound(low, tables[c].end(), (probed+1)<<48));
+
+                    // Parsing candidates
+                    for(auto key(low); key!=high; key++){
+
+                        // Candidate viewpoint slot
+                        unsigned int slot(std::find(slots.begin(), slots.end(), ((*key)>>24)&0xFFFFFF)-slots.begin());
+                        if(slot==slots.size()){
+                            continue;
+                        }
+
+                        // Skip candidate already compared with the query
+                        uint32_t t((*key)&0xFFFFFF);
+                        if(threadStamp[slot][t]==q+1){
+                            continue;
+                        }
+                        threadStamp[slot][t]=q+1;
+
+                        // Hamming distance
+                        uint64_t const * b(trains[slot]+t*words);
+                        uint64_t distance(0);
+                        for(size_t w(0); w<words; w++){
+                            distance+=__builtin_popcountll(a[w]^b[w]);
+                        }
+                        comparisons++;
+
+                        // Update candidates
+                        uint64_t & best(rowBest[q*slots.size()+slot]);
+                        best=std::min(best,(distance<<32)|t);
+                        threadBest[slot][t]=std::min(threadBest[slot][t],(distance<<32)|q);
+
+                    }
+
+                }
+
+            }
+
+        }
+
+        // Reduce train candidates
+        # pragma omp critical
+        for(unsigned int s(0); s<threadBest.size(); s++){
+            for(size_t t(0); t<threadBest[s].size(); t++){
+                colBest[s][t]=std::min(colBest[s][t],threadBest[s][t]);
+            }
+        }
+
+    }
+
+    // Exhaustive resolution of queries without a candidate under the bound - cross-check identical to the exhaustive matcher
+    for(unsigned int s(0); s<slots.size(); s++){
+
+        // Queries beyond the bound
+        std::vector<uint32_t> rows;
+        for(uint32_t q(0); q<n1; q++){
+            if((rowBest[q*slots.size()+s]>>32)>bound){
+                rows.push_back(q);
+            }
+        }
+        fallback+=rows.size();
+
+        // Exhaustive queries best candidates
+        # pragma omp parallel for schedule(dynamic) reduction(+:comparisons)
+        for(size_t r=0; r<rows.size(); r++){
+            uint64_t const * a(query.data()+rows[r]*words);
+            uint64_t best(UINT64_MAX);
+            for(uint32_t t(0); t<sizes[s]; t++){
+                uint64_t const * b(trains[s]+t*words);
+                uint64_t distance(0);
+                for(size_t w(0); w<words; w++){
+                    distance+=__builtin_popcountll(a[w]^b[w]);
+                }
+                best=std::min(best,(distance<<32)|t);
+            }
+            rowBest[rows[r]*slots.size()+s]=best;
+            comparisons+=sizes[s];
+        }
+
+        // Train candidates of the exhaustive queries
+        std::vector<uint32_t> cols;
+        for(auto & q: rows){
+            if(rowBest[q*slots.size()+s]!=UINT64_MAX){
+                cols.push_back(rowBest[q*slots.size()+s]&0xFFFFFFFF);
+            }
+        }
+        std::sort(cols.begin(), cols.end());
+        cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+
+        // Exhaustive train candidates best queries
+        # pragma omp parallel for schedule(dynamic) reduction(+:comparisons)
+        for(size_t k=0; k<cols.size(); k++){
+            uint64_t const * b(trains[s]+cols[k]*words);
+            uint64_t best(UINT64_MAX);
+            for(uint32_t q(0); q<n1; q++){
+                uint64_t const * a(query.data()+q*words);
+                uint64_t distance(0);
+                for(size_t w(0); w<words; w++){
+                    distance+=__builtin_popcountll(a[w]^b[w]);
+                }
+                best=std::min(best,(distance<<32)|q);
+            }
+            colBest[s][cols[k]]=best;
+            comparisons+=n1;
+        }
+
+    }
+
+    // Keep mutual best candidates per viewpoint
+    for(unsigned int s(0); s<slots.size(); s++){
+        for(uint32_t q(0); q<n1; q++){
+            uint64_t best(rowBest[q*slots.size()+s]);
+            uint32_t t(best&0xFFFFFFFF);
+            if((best!=UINT64_MAX)&&((colBest[s][t]&0xFFFFFFFF)==q)){
+                (*matches)[s].push_back(cv::DMatch(q, t, float(best>>32)));
+            }
+        }
+    }
+
+    // Return candidate comparisons count
+    return comparisons;
+
+}
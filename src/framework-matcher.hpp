@@ -0,0 +1,80 @@
+/*
+ *  sfs-framework
+ *
+ *      Nils Hamel - nils.hamel@bluewin.ch
+ *      Charles Papon - charles.papon.90@gmail.com
+ *      Copyright (c) 2019-2020 DHLAB, EPFL & HES-SO Valais-Wallis
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// External includes
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+#include <cmath>
+#include <immintrin.h>
+#include <Eigen/Core>
+#include <opencv4/opencv2/core.hpp>
+
+// Matching modes
+#define MATCHER_MODE_BRUTE     ( 0 ) /* OpenCV brute-force matcher with cross-check */
+#define MATCHER_MODE_HAMMING   ( 1 ) /* Single pass bidirectional Hamming matcher */
+#define MATCHER_MODE_BENCHMARK ( 2 ) /* Hamming matcher compared against brute-force matcher */
+
+// Descriptor tiles dimension - a train tile of 256 padded descriptors fits in L1 cache
+#define MATCHER_TILE_QUERY     ( 64 )
+#define MATCHER_TILE_TRAIN     ( 256 )
+
+// Multi-index hashing chunk size in bits and probing radius in bits per chunk
+#define MATCHER_INDEX_CHUNK    ( 16 )
+#define MATCHER_INDEX_RADIUS   ( 1 )
+
+// Module object - multi-index hashing of the descriptors of a viewpoints window
+class MatcherIndex {
+
+public: /* Need to be set back to private */
+    std::vector<std::vector<uint64_t>> tables; /* Per chunk sorted keys : chunk value, viewpoint, descriptor */
+    std::map<unsigned int, std::vector<uint64_t>> packed; /* Per viewpoint padded descriptors */
+    std::map<unsigned int, uint32_t> counts; /* Per viewpoint descriptors count */
+    size_t words;
+    unsigned long fallback; /* Queries of the last match resolved exhaustively */
+
+public:
+    MatcherIndex() : words(0), fallback(0) {}
+    bool hasViewpoint(unsigned int viewpoint);
+    void insert(unsigned int viewpoint, cv::Mat * desc);
+    void remove(unsigned int viewpoint);
+    void retain(std::vector<unsigned int> * viewpoints);
+    unsigned long match(cv::Mat * desc, std::vector<unsigned int> * viewpoints, std::vector<std::vector<cv::DMatch>> * matches);
+
+};
+
+int matcherMode(std::string modeName);
+
+size_t matcherPack(cv::Mat * desc, std::vector<uint64_t> * packed);
+
+void matcherCrossCheck(uint64_t const * p1, uint32_t n1, uint64_t const * p2, uint32_t n2, size_t words, std::vector<cv::DMatch> * matches);
+
+void matcherHamming(cv::Mat * d1, cv::Mat * d2, std::vector<cv::DMatch> * matches);
+
+unsigned long matcherGuided(cv::Mat * d1, std::vector<Eigen::Vector3d> * b1, cv::Mat * d2, std::vector<Eigen::Vector3d> * b2, double window, std::vector<cv::DMatch> * matches);
+
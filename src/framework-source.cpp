@@ -21,15 +21,48 @@
 
 #include "framework-source.hpp"
 
+//
+//  Generic source
+//
+
+std::shared_ptr<Viewpoint> Source::next(){
+
+    /* Image path */
+    std::string imagePath;
+
+    /* Create new viewpoint instance */
+    std::shared_ptr<Viewpoint> pushViewpoint = reserve(&imagePath);
+
+    /* import and scale image */
+    if(import(pushViewpoint, imagePath)==false){
+
+        /* send critical message */
+        throw std::runtime_error("Error : unable to import image " + imagePath);
+
+    }
+
+    /* return created viewpoint */
+    return pushViewpoint;
+
+}
+
+bool Source::import(std::shared_ptr<Viewpoint> viewpoint, std::string imagePath){
+
+    /* import and scale image */
+    return viewpoint->setImage(imagePath, imageScale, imageDecode);
+
+}
+
 //
 //  Sparse source
 //
 
-SourceSparse::SourceSparse(std::string imageFolder, std::string firstImage, std::string lastImage, uint32_t increment, double scale) :
+SourceSparse::SourceSparse(std::string imageFolder, std::string firstImage, std::string lastImage, uint32_t increment, double scale, int decode) :
 
     Source(
         increment, 
-        scale
+        scale,
+        decode
     )
 
 {
@@ -106,18 +139,13 @@ SourceSparse::SourceSparse(std::string imageFolder, std::string firstImage, std:
 
 }
 
-std::shared_ptr<Viewpoint> SourceSparse::next(){
+std::shared_ptr<Viewpoint> SourceSparse::reserve(std::string * imagePath){
 
     /* Create new viewpoint instance */
     std::shared_ptr<Viewpoint> pushViewpoint = std::make_shared<Viewpoint>();
 
-    /* import and scale image */
-    if(pushViewpoint->setImage(files[fileIndex], imageScale)==false){
-
-        /* send critical message */
-        throw std::runtime_error("Error : unable to import image " + files[fileIndex]);
-
-    }
+    /* assign image path */
+    (*imagePath) = files[fileIndex];
 
     /* assign viewpoint uid (filename) */
     pushViewpoint->uid = fs::path(files[fileIndex]).filename();
@@ -141,11 +169,12 @@ bool SourceSparse::hasNext(){
 //  Dense source
 //
 
-SourceDense::SourceDense(std::string imageFolder, std::string transformationFile, std::string firstImage, std::string lastImage, int increment, double scale) : 
+SourceDense::SourceDense(std::string imageFolder, std::string transformationFile, std::string firstImage, std::string lastImage, int increment, double scale, int decode) : 
 
     Source(
         increment, 
-        scale
+        scale,
+        decode
     ), 
     pictureFolder(imageFolder) 
 
@@ -254,19 +283,14 @@ SourceDense::SourceDense(std::string imageFolder, std::string transformationFile
 
 }
 
-std::shared_ptr<Viewpoint> SourceDense::next(){
+std::shared_ptr<Viewpoint> SourceDense::reserve(std::string * imagePath){
 
     /* Create new viewpoint instance */
     std::shared_ptr<Viewpoint> pushViewpoint = std::make_shared<Viewpoint>();
 
-    /* import and scale image */
-    if(pushViewpoint->setImage(pictureFolder + "/" + list[fileIndex].fileName, imageScale)==false){
+    /* assign image path */
+    (*imagePath) = pictureFolder + "/" + list[fileIndex].fileName;
 
-        /* send critical message */
-        throw std::runtime_error("Error : unable to import image " + list[fileIndex].fileName);
-
-    }
-    
     /* assign viewpoint uid (filename) */
     pushViewpoint->uid = list[fileIndex].fileName;
 
@@ -291,3 +315,220 @@ bool SourceDense::hasNext(){
 
 }
 
+//
+//  Prefetch source
+//
+
+SourcePrefetch::SourcePrefetch(Source * source, unsigned int threads, unsigned int depth, size_t memory) :
+
+    Source(),
+    source(source),
+    queuePush(0),
+    queuePop(0),
+    queueDepth(depth>0 ? depth : 1),
+    queueMemory(0),
+    queueLimit(memory>0 ? memory : SIZE_MAX),
+    queueStop(false),
+    queueActive(0)
+
+{
+
+    /* Start decoding threads */
+    for(unsigned int i(0); i<(threads>0 ? threads : 1); i++){
+
+        /* Create worker */
+        workers.emplace_back(&SourcePrefetch::worker, this);
+
+    }
+
+}
+
+SourcePrefetch::~SourcePrefetch(){
+
+    /* Signal workers termination */
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queueStop = true;
+    }
+    queueSlot.notify_all();
+
+    /* Wait workers termination */
+    for(auto & thread: workers){
+        thread.join();
+    }
+
+    /* Delete wrapped source */
+    delete source;
+
+}
+
+void SourcePrefetch::worker(){
+
+    /* Image path */
+    std::string imagePath;
+
+    /* Reserved viewpoint */
+    std::shared_ptr<Viewpoint> pushViewpoint;
+
+    /* Reserved viewpoint sequence */
+    unsigned long pushIndex(0);
+
+    /* Viewpoint processing */
+    std::function<void(Viewpoint *)> pushProcess;
+
+    /* Queue lock */
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    /* Decoding loop */
+    while(true){
+
+        /* Wait for a slot : depth limit and memory cap - a frame is always allowed when nothing is pending */
+        queueSlot.wait(lock, [this]{
+            return queueStop || ( source->hasNext() && (queuePush-queuePop)<queueDepth && (queueMemory<queueLimit || queuePush==queuePop) );
+        });
+
+        /* Check termination */
+        if(queueStop==true){
+            return;
+        }
+
+        /* Reserve next viewpoint - keeps the source order */
+        pushIndex = queuePush ++;
+        pushViewpoint = source->reserve(&imagePath);
+
+        /* Retrieve processing */
+        pushProcess = queueProcess;
+        if(pushProcess){
+            queueActive ++;
+        }
+
+        /* Failure message */
+        std::string failure;
+
+        /* Decode image and process viewpoint outside of lock - failures forwarded to the consumer in frame order */
+        lock.unlock();
+        try{
+            if(source->import(pushViewpoint, imagePath)==false){
+                failure = "Error : unable to import image " + imagePath;
+            }else if(pushProcess){
+                pushProcess(pushViewpoint.get());
+            }
+        }catch(std::exception const & error){
+            failure = error.what();
+        }catch(...){
+            failure = "Error : unable to process image " + imagePath;
+        }
+        lock.lock();
+
+        /* Release processing */
+        if(pushProcess){
+            queueActive --;
+            pushProcess = nullptr;
+        }
+
+        /* Push decoded viewpoint or failure */
+        if(failure.empty()){
+            size_t footprint(pushViewpoint->getImage()->total()*pushViewpoint->getImage()->elemSize());
+            footprint += pushViewpoint->getCvDescriptor()->total()*pushViewpoint->getCvDescriptor()->elemSize();
+            footprint += pushViewpoint->getCvFeatures()->size()*sizeof(cv::KeyPoint);
+            queue[pushIndex] = std::make_pair(pushViewpoint, footprint);
+            queueMemory += footprint;
+        }else{
+            queueFail[pushIndex] = failure;
+        }
+
+        /* Release reference outside of queue */
+        pushViewpoint.reset();
+
+        /* Signal consumer */
+        queueReady.notify_all();
+
+    }
+
+}
+
+std::shared_ptr<Viewpoint> SourcePrefetch::next(){
+
+    /* Queue lock */
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    /* Check queue exhaust */
+    if((queuePush==queuePop)&&(source->hasNext()==false)){
+
+        /* send critical message */
+        throw std::runtime_error("Error : prefetch source exhausted");
+
+    }
+
+    /* Wait for next viewpoint in sequence */
+    queueReady.wait(lock, [this]{
+        return (queue.count(queuePop)>0) || (queueFail.count(queuePop)>0);
+    });
+
+    /* Check decoding or processing failure */
+    auto fail = queueFail.find(queuePop);
+    if(fail!=queueFail.end()){
+
+        /* Release slot */
+        std::string failure(fail->second);
+        queueFail.erase(fail);
+        queuePop ++;
+        queueSlot.notify_all();
+
+        /* send critical message */
+        throw std::runtime_error(failure);
+
+    }
+
+    /* Pop viewpoint */
+    auto entry = queue.find(queuePop);
+    std::shared_ptr<Viewpoint> popViewpoint(entry->second.first);
+    queueMemory -= entry->second.second;
+    queue.erase(entry);
+    queuePop ++;
+
+    /* Signal workers */
+    queueSlot.notify_all();
+
+    /* return decoded viewpoint */
+    return popViewpoint;
+
+}
+
+bool SourcePrefetch::hasNext(){
+
+    /* Queue lock */
+    std::lock_guard<std::mutex> lock(queueMutex);
+
+    /* Detect pending viewpoints or remaining source */
+    return (queuePush>queuePop) || source->hasNext();
+
+}
+
+std::shared_ptr<Viewpoint> SourcePrefetch::reserve(std::string * imagePath){
+
+    /* Queue lock */
+    std::lock_guard<std::mutex> lock(queueMutex);
+
+    /* Forward reservation to wrapped source - bypass the decoding queue */
+    return source->reserve(imagePath);
+
+}
+
+bool SourcePrefetch::setProcess(std::function<void(Viewpoint *)> process){
+
+    /* Queue lock */
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    /* Assign processing */
+    queueProcess = process;
+
+    /* Wait for running processing - previous processing is no more called on return */
+    queueReady.wait(lock, [this]{
+        return queueActive==0;
+    });
+
+    /* Processing accepted */
+    return true;
+
+}
@@ -25,6 +25,11 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 #include <experimental/filesystem>
 #include <opencv4/opencv2/core.hpp>
 
@@ -42,13 +47,17 @@ protected:
     int fileLastIndex;
     int fileIncrement;
     double imageScale;
+    int imageDecode;
 
 public:
 	Source() {}
-    Source(int increment, double scale) : fileIndex(-1), fileLastIndex(-1), fileIncrement(increment), imageScale(scale) {}
+    Source(int increment, double scale, int decode) : fileIndex(-1), fileLastIndex(-1), fileIncrement(increment), imageScale(scale), imageDecode(decode) {}
 	virtual ~Source() {}
-	virtual std::shared_ptr<Viewpoint> next() = 0;
+	virtual std::shared_ptr<Viewpoint> next();
 	virtual bool hasNext() = 0;
+    virtual std::shared_ptr<Viewpoint> reserve(std::string * imagePath) = 0;
+    virtual bool setProcess(std::function<void(Viewpoint *)> process) { return false; }
+    bool import(std::shared_ptr<Viewpoint> viewpoint, std::string imagePath);
 
 };
 
@@ -59,10 +68,10 @@ private:
 	std::vector<std::string> files;
 
 public:
-    SourceSparse(std::string imageFolder, std::string firstImage, std::string lastImage, uint32_t increment, double scale);
+    SourceSparse(std::string imageFolder, std::string firstImage, std::string lastImage, uint32_t increment, double scale, int decode);
 	~SourceSparse() {}
-	std::shared_ptr<Viewpoint> next();
 	bool hasNext();
+    std::shared_ptr<Viewpoint> reserve(std::string * imagePath);
 
 };
 
@@ -80,10 +89,41 @@ private:
     std::string pictureFolder;
 
 public:
-    SourceDense(std::string imageFolder, std::string transformationFile, std::string firstFile, std::string lastFile, int increment, double scale);
+    SourceDense(std::string imageFolder, std::string transformationFile, std::string firstFile, std::string lastFile, int increment, double scale, int decode);
     ~SourceDense() {}
+    bool hasNext();
+    std::shared_ptr<Viewpoint> reserve(std::string * imagePath);
+
+};
+
+// Module derived object - Wraps a source and decodes its images ahead on worker threads
+class SourcePrefetch : public Source{
+
+private:
+    Source * source;
+    std::vector<std::thread> workers;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::condition_variable queueSlot;
+    std::map<unsigned long, std::pair<std::shared_ptr<Viewpoint>, size_t>> queue;
+    std::map<unsigned long, std::string> queueFail; /* Failure message of decoded or processed viewpoints */
+    unsigned long queuePush;  /* Amount of reserved viewpoints */
+    unsigned long queuePop;   /* Amount of delivered viewpoints */
+    unsigned int queueDepth;  /* Maximum amount of reserved and not delivered viewpoints */
+    size_t queueMemory;       /* Memory held by decoded and not delivered viewpoints */
+    size_t queueLimit;        /* Memory cap on decoded and not delivered viewpoints */
+    bool queueStop;
+    std::function<void(Viewpoint *)> queueProcess; /* Processing applied on decoded viewpoints */
+    unsigned int queueActive; /* Amount of workers running the processing */
+    void worker();
+
+public:
+    SourcePrefetch(Source * source, unsigned int threads, unsigned int depth, size_t memory);
+    ~SourcePrefetch();
     std::shared_ptr<Viewpoint> next();
     bool hasNext();
+    std::shared_ptr<Viewpoint> reserve(std::string * imagePath);
+    bool setProcess(std::function<void(Viewpoint *)> process);
 
 };
 
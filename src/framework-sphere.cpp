@@ -0,0 +1,255 @@
+/*
+ *  sfs-framework
+ *
+ *      Nils Hamel - nils.hamel@bluewin.ch
+ *      Charles Papon - charles.papon.90@gmail.com
+ *      Copyright (c) 2019-2020 DHLAB, EPFL & HES-SO Valais-Wallis
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framework-sphere.hpp"
+
+SphereGrid::SphereGrid(int bands, bool latitudeShift, bool longitudeShift){
+
+    // Band latitude height
+    double height(M_PI/bands);
+
+    // Bands lower latitude - half height polar caps when shifted
+    bandLow.push_back(-M_PI/2.);
+    for(int b(1); b<bands+(latitudeShift?1:0); b++){
+        bandLow.push_back(-M_PI/2.+(b-(latitudeShift?0.5:0.))*height);
+    }
+
+    // Longitude cells offset
+    shiftLongitude=longitudeShift?0.5:0.;
+
+    // Bands cells count - cell area close to equatorial square cell area
+    cells=0;
+    for(unsigned int b(0); b<bandLow.size(); b++){
+        double bandHigh(b+1<bandLow.size() ? bandLow[b+1] : M_PI/2.);
+        bandOffset.push_back(cells);
+        bandCells.push_back(std::max(1,int(std::round(2.*M_PI*(std::sin(bandHigh)-std::sin(bandLow[b]))/(height*height)))));
+        cells+=bandCells.back();
+    }
+
+    // Cells neighbourhood - 3x3 pattern with longitude wrap-around
+    neighbours.assign(cells*9,-1);
+    for(int b(0); b<int(bandLow.size()); b++){
+        for(int c(0); c<bandCells[b]; c++){
+
+            // Cell centre longitude in turn fraction
+            double center((c+0.5-shiftLongitude)/bandCells[b]);
+
+            // Parsing adjacent bands
+            for(int db(-1); db<=1; db++){
+
+                // Check band existence
+                int nb(b+db);
+                if((nb<0)||(nb>=int(bandLow.size()))){
+                    continue;
+                }
+
+                // Adjacent band cell under the cell centre
+                int nc(int(std::floor(center*bandCells[nb]+shiftLongitude))%bandCells[nb]);
+
+                // Parsing longitude neighbours - duplicated cells are ignored on narrow bands
+                for(int dc(-1); dc<=1; dc++){
+                    if((bandCells[nb]<3)&&(dc!=0)){
+                        continue;
+                    }
+                    neighbours[(bandOffset[b]+c)*9+(db+1)*3+(dc+1)]=bandOffset[nb]+(nc+dc+bandCells[nb])%bandCells[nb];
+                }
+
+            }
+
+        }
+    }
+
+}
+
+int SphereGrid::getCount(){
+
+    // Return cells count
+    return cells;
+
+}
+
+int SphereGrid::getCell(double u, double v){
+
+    // Compute latitude
+    double phi((v-0.5)*M_PI);
+
+    // Search latitude band
+    int band(std::upper_bound(bandLow.begin(), bandLow.end(), phi)-bandLow.begin()-1);
+    band=std::max(0,std::min(int(bandLow.size())-1,band));
+
+    // Compute cell index with longitude wrap-around
+    int cell(int(std::floor(u*bandCells[band]+shiftLongitude))%bandCells[band]);
+    if(cell<0){
+        cell+=bandCells[band];
+    }
+
+    // Return cell index
+    return bandOffset[band]+cell;
+
+}
+
+int const * SphereGrid::getNeighbours(int cell){
+
+    // Return cell neighbourhood
+    return neighbours.data()+cell*9;
+
+}
+
+SphereFilter::SphereFilter(int bands){
+
+    // Shifted grids - counterpart of the planar GMS grid types
+    grids.push_back(SphereGrid(bands, false, false));
+    grids.push_back(SphereGrid(bands, false, true));
+    grids.push_back(SphereGrid(bands, true, false));
+    grids.push_back(SphereGrid(bands, true, true));
+
+    // Statistics allocation - cleared after each use
+    int cells(0);
+    for(auto & grid: grids){
+        cells=std::max(cells, grid.getCount());
+    }
+    statistics.assign(cells*cells, 0);
+    cellPoints.assign(cells, 0);
+    cellPairs.assign(cells, -1);
+    cellBest.assign(cells, 0);
+
+}
+
+int SphereFilter::filter(std::vector<cv::KeyPoint> * k1, cv::Size s1, std::vector<cv::KeyPoint> * k2, cv::Size s2, std::vector<cv::DMatch> * candidates, std::vector<cv::DMatch> * matches, unsigned long * visited){
+
+    // Candidates count
+    size_t count(candidates->size());
+
+    // Inliers count
+    int inlierCount(0);
+
+    // Reset inliers
+    inliers.assign(count, 0);
+    pairLeft.resize(count);
+    pairRight.resize(count);
+
+    // Parsing shifted grids
+    for(auto & grid: grids){
+
+        // Cells count
+        int cells(grid.getCount());
+
+        // Assign candidates to cell pairs - same grid on both sides
+        cellUsed.clear();
+        for(size_t i(0); i<count; i++){
+            cv::Point2f const & p1((*k1)[(*candidates)[i].queryIdx].pt);
+            cv::Point2f const & p2((*k2)[(*candidates)[i].trainIdx].pt);
+            pairLeft[i]=grid.getCell(p1.x/s1.width, p1.y/(s1.height-1));
+            pairRight[i]=grid.getCell(p2.x/s2.width, p2.y/(s2.height-1));
+            statistics[pairLeft[i]*cells+pairRight[i]]++;
+            if((cellPoints[pairLeft[i]]++)==0){
+                cellUsed.push_back(pairLeft[i]);
+            }
+        }
+
+        // Most populated right cell of every used left cell - lowest index on ties
+        for(size_t i(0); i<count; i++){
+            int value(statistics[pairLeft[i]*cells+pairRight[i]]);
+            if((value>cellBest[pairLeft[i]])||((value==cellBest[pairLeft[i]])&&(pairRight[i]<cellPairs[pairLeft[i]]))){
+                cellBest[pairLeft[i]]=value;
+                cellPairs[pairLeft[i]]=pairRight[i];
+            }
+        }
+
+        // Verify used cell pairs on their neighbourhood - single hypothesis
+        for(auto & cell: cellUsed){
+
+            // Cells neighbourhood
+            int const * left(grid.getNeighbours(cell));
+            int const * right(grid.getNeighbours(cellPairs[cell]));
+
+            // Neighbourhood score and threshold
+            int score(0);
+            double threshold(0.);
+            int pairs(0);
+            for(int j(0); j<9; j++){
+                if((left[j]<0)||(right[j]<0)){
+                    continue;
+                }
+                score+=statistics[left[j]*cells+right[j]];
+                threshold+=cellPoints[left[j]];
+                pairs++;
+            }
+
+            // Reject insufficiently supported cell pair
+            if(score<SPHERE_THRESHOLD*std::sqrt(threshold/pairs)){
+                cellPairs[cell]=-2;
+            }
+
+        }
+
+        // Mark inliers
+        for(size_t i(0); i<count; i++){
+            if(cellPairs[pairLeft[i]]==pairRight[i]){
+                inliers[i]=1;
+            }
+        }
+
+        // Update visited cells count
+        if(visited!=NULL){
+            (*visited)+=cellUsed.size();
+        }
+
+        // Clear used statistics
+        for(size_t i(0); i<count; i++){
+            statistics[pairLeft[i]*cells+pairRight[i]]=0;
+        }
+        for(auto & cell: cellUsed){
+            cellPoints[cell]=0;
+            cellPairs[cell]=-1;
+            cellBest[cell]=0;
+        }
+
+    }
+
+    // Filter matches
+    matches->clear();
+    for(size_t i(0); i<count; i++){
+        if(inliers[i]!=0){
+            matches->push_back((*candidates)[i]);
+            inlierCount++;
+        }
+    }
+
+    // Return inliers count
+    return inlierCount;
+
+}
+
+int sphereMode(std::string modeName){
+
+    // Convert statistics grid mode name
+    if(modeName=="planar"){
+        return SPHERE_MODE_PLANAR;
+    }else
+    if(modeName=="spherical"){
+        return SPHERE_MODE_SPHERICAL;
+    }
+
+    // Send critical message
+    throw std::runtime_error("Error : unknown statistics grid mode " + modeName);
+
+}
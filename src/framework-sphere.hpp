@@ -0,0 +1,81 @@
+/*
+ *  sfs-framework
+ *
+ *      Nils Hamel - nils.hamel@bluewin.ch
+ *      Charles Papon - charles.papon.90@gmail.com
+ *      Copyright (c) 2019-2020 DHLAB, EPFL & HES-SO Valais-Wallis
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// External includes
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <opencv4/opencv2/core.hpp>
+
+// Statistics grid modes
+#define SPHERE_MODE_PLANAR    ( 0 ) /* Planar GMS grid with scale and rotation hypotheses */
+#define SPHERE_MODE_SPHERICAL ( 1 ) /* Equal-area spherical GMS grid with longitude wrap-around */
+
+// Spherical grid latitude bands count - equatorial cells match the planar 20x20 grid
+#define SPHERE_BANDS          ( 20 )
+
+// Spherical grid motion statistics threshold factor
+#define SPHERE_THRESHOLD      ( 4. )
+
+// Module object
+class SphereGrid {
+
+public: /* Need to be set back to private */
+    std::vector<double> bandLow;
+    std::vector<int> bandOffset;
+    std::vector<int> bandCells;
+    std::vector<int> neighbours;
+    double shiftLongitude;
+    int cells;
+
+public:
+    SphereGrid(int bands, bool latitudeShift, bool longitudeShift);
+    int getCount();
+    int getCell(double u, double v);
+    int const * getNeighbours(int cell);
+
+};
+
+// Module object
+class SphereFilter {
+
+public: /* Need to be set back to private */
+    std::vector<SphereGrid> grids;
+    std::vector<int> statistics;
+    std::vector<int> cellPoints;
+    std::vector<int> cellPairs;
+    std::vector<int> cellBest;
+    std::vector<int> cellUsed;
+    std::vector<int> pairLeft;
+    std::vector<int> pairRight;
+    std::vector<char> inliers;
+
+public:
+    SphereFilter(int bands);
+    int filter(std::vector<cv::KeyPoint> * k1, cv::Size s1, std::vector<cv::KeyPoint> * k2, cv::Size s2, std::vector<cv::DMatch> * candidates, std::vector<cv::DMatch> * matches, unsigned long * visited);
+
+};
+
+int sphereMode(std::string modeName);
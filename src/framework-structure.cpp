@@ -212,6 +212,21 @@ void Structure::computeCorrelation(std::vector<std::shared_ptr<Transform>> & tra
 
 }
 
+void Structure::computeMoments(std::vector<std::shared_ptr<Transform>> & transforms, unsigned int lowViewpoint){
+
+    // Low index
+    unsigned int index(0);
+
+    // Detect and add features contribution to centroid and correlation moments
+    for(unsigned int i(features.size()-1); i>0; i--){
+        if((index=features[i-1]->getViewpoint()->getIndex())>=lowViewpoint){
+            if((features[i]->getViewpoint()->getIndex()-index)==1){
+                transforms[index]->pushMoments(features[i-1]->getModel(), features[i]->getModel());
+            }
+        }
+    }
+
+}
 
 void Structure::computeOriented(unsigned int lowViewpoint){
 
@@ -279,6 +294,39 @@ void Structure::computeOptimalPosition(unsigned int lowViewpoint){
 
 }
 
+void Structure::computeClosedPosition(unsigned int lowViewpoint){
+
+    // Normal equations of the distance to rays
+    Eigen::Matrix3d normal(Eigen::Matrix3d::Zero());
+    Eigen::Vector3d vector(Eigen::Vector3d::Zero());
+
+    // Ray projector
+    Eigen::Matrix3d projector;
+
+    // Accumulate rays orthogonal projectors - (I - d.d^T) on unit models
+    for(auto & feature: features){
+        if(feature->getViewpoint()->getIndex()>=lowViewpoint){
+            projector=Eigen::Matrix3d::Identity()-(*feature->getModel())*(feature->getModel()->transpose());
+            normal+=projector;
+            vector+=projector*(*feature->getViewpoint()->getPosition());
+        }
+    }
+
+    // Decompose normal equations
+    Eigen::LDLT<Eigen::Matrix3d> decomposition(normal);
+
+    // Degenerated rays : single ray or no baseline - non-finite position as with pairwise estimation
+    double pivotMax(decomposition.vectorD().cwiseAbs().maxCoeff());
+    if((decomposition.info()!=Eigen::Success)||(decomposition.vectorD().cwiseAbs().minCoeff()<=STRUCTURE_CLOSED_CONDITION*pivotMax)){
+        position=Eigen::Vector3d::Constant(std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+
+    // Compute optimal position
+    position=decomposition.solve(vector);
+
+}
+
 void Structure::computeRadius(unsigned int lowViewpoint){
     
     // Feature position in absolute frame
@@ -331,6 +379,23 @@ void Structure::computeDisparityStd(double * const stdValue, double const meanVa
 
 }
 
+void Structure::computeDisparityMoments(double * const countValue, double * const meanValue, double * const squareValue, unsigned int lowViewpoint){
+
+    // Deviation to running mean
+    double delta(0.);
+
+    // Update running count, mean and sum of squared deviations - Welford update
+    for(auto & feature: features){
+        if(feature->getViewpoint()->getIndex()>=lowViewpoint){
+            (*countValue)+=1.;
+            delta=feature->getDisparity()-(*meanValue);
+            (*meanValue)+=delta/(*countValue);
+            (*squareValue)+=delta*(feature->getDisparity()-(*meanValue));
+        }
+    }
+
+}
+
 void Structure::filterRadialRange(double lowClamp, double highClamp,unsigned int lowViewpoint){
 
     // Re-sampling index
@@ -407,3 +472,21 @@ void Structure::filterResize(unsigned int resize){
 
 }
 
+int structureMode(std::string modeName){
+
+    // Convert triangulation mode name
+    if(modeName=="pairwise"){
+        return STRUCTURE_TRIANGULATION_PAIRWISE;
+    }else
+    if(modeName=="closed"){
+        return STRUCTURE_TRIANGULATION_CLOSED;
+    }else
+    if(modeName=="benchmark"){
+        return STRUCTURE_TRIANGULATION_BENCHMARK;
+    }
+
+    // Send critical message
+    throw std::runtime_error("Error : unknown triangulation mode " + modeName);
+
+}
+
@@ -23,6 +23,7 @@
 
 // External includes
 #include <vector>
+#include <string>
 #include <Eigen/Dense>
 
 // Internal includes
@@ -36,6 +37,14 @@
 #define STRUCTURE_NORMAL ( 1 ) /* Normal structure, containing two features or more */
 #define STRUCTURE_PIONER ( 2 ) /* Structure that contains all the last viewpoints in the pipeline active head (configGroup) */
 
+// Define structure triangulation modes
+#define STRUCTURE_TRIANGULATION_PAIRWISE  ( 0 ) /* Mean of pairwise rays midpoints */
+#define STRUCTURE_TRIANGULATION_CLOSED    ( 1 ) /* Least-squares point closest to all rays */
+#define STRUCTURE_TRIANGULATION_BENCHMARK ( 2 ) /* Both estimators compared, pairwise kept */
+
+// Closed-form triangulation - smallest over largest normal equations pivot below which rays are degenerated
+#define STRUCTURE_CLOSED_CONDITION ( 1e-12 )
+
 // Module object
 class Structure {
 
@@ -44,6 +53,7 @@ public: /* Need to be set back to private */
     std::vector<Feature*> features;
     unsigned int state;
     unsigned int start;
+    unsigned int slot; /* Position in the database structures stack */
 
 public:
     Structure() : position(Eigen::Vector3d::Zero()), state(STRUCTURE_REMOVE) {}
@@ -60,13 +70,18 @@ public:
     void computeModel();
     void computeCentroid(std::vector<std::shared_ptr<Transform>> & transforms, unsigned int lowViewpoint);
     void computeCorrelation(std::vector<std::shared_ptr<Transform>> & transforms, unsigned int lowViewpoint);
+    void computeMoments(std::vector<std::shared_ptr<Transform>> & transforms, unsigned int lowViewpoint);
     void computeOriented(unsigned int lowViewpoint);
     void computeOptimalPosition(unsigned int lowViewpoint);
+    void computeClosedPosition(unsigned int lowViewpoint);
     void computeRadius(unsigned int lowViewpoint);
     unsigned int computeDisparityMean(double * const meanValue,unsigned int lowViewpoint);
     void computeDisparityStd(double * const stdValue, double const meanValue,unsigned int lowViewpoint);
+    void computeDisparityMoments(double * const countValue, double * const meanValue, double * const squareValue, unsigned int lowViewpoint);
     void filterRadialRange(double lowClamp, double highClamp,unsigned int lowViewpoint);
     void filterDisparity(double limitValue,unsigned int headStart);
     void filterResize(unsigned int resize);
 
 };
+
+int structureMode(std::string modeName);
@@ -65,48 +65,128 @@ void Transform::setScale(){
 
 void Transform::pushCorrelation(Eigen::Vector3d * firstComponent, Eigen::Vector3d * secondComponent){
 
+    // Thread partial accumulator
+    double * partial(partials.data()+omp_get_thread_num()*TRANSFORM_PARTIAL_STRIDE);
+
     // Compute correlation component
-    # pragma omp critical
-    correlation+=((*firstComponent)-centerFirst)*((*secondComponent)-centerSecond).transpose();
+    Eigen::Map<Eigen::Matrix3d>(partial+TRANSFORM_PARTIAL_MATRIX)+=((*firstComponent)-centerFirst)*((*secondComponent)-centerSecond).transpose();
 
 }
 
 void Transform::pushCentroid(Eigen::Vector3d * pushFirst, Eigen::Vector3d * pushSecond){
 
+    // Thread partial accumulator
+    double * partial(partials.data()+omp_get_thread_num()*TRANSFORM_PARTIAL_STRIDE);
+
     // Push centroid component
-    # pragma omp critical
-    {
-    centerFirst +=*pushFirst;
-    centerSecond+=*pushSecond;
-    count++;
-    }
+    Eigen::Map<Eigen::Vector3d>(partial+TRANSFORM_PARTIAL_FIRST )+=*pushFirst;
+    Eigen::Map<Eigen::Vector3d>(partial+TRANSFORM_PARTIAL_SECOND)+=*pushSecond;
+    partial[TRANSFORM_PARTIAL_COUNT]+=1.;
+
+}
+
+void Transform::pushMoments(Eigen::Vector3d * pushFirst, Eigen::Vector3d * pushSecond){
+
+    // Thread partial accumulator
+    double * partial(partials.data()+omp_get_thread_num()*TRANSFORM_PARTIAL_STRIDE);
+
+    // Thread running means and co-moment
+    Eigen::Map<Eigen::Vector3d> meanFirst (partial+TRANSFORM_PARTIAL_FIRST );
+    Eigen::Map<Eigen::Vector3d> meanSecond(partial+TRANSFORM_PARTIAL_SECOND);
+
+    // Update count and first component mean
+    partial[TRANSFORM_PARTIAL_COUNT]+=1.;
+    Eigen::Vector3d deltaFirst((*pushFirst)-meanFirst);
+    meanFirst+=deltaFirst/partial[TRANSFORM_PARTIAL_COUNT];
+
+    // Update second component mean and co-moment - Welford centred update, no cancellation far from origin
+    meanSecond+=((*pushSecond)-meanSecond)/partial[TRANSFORM_PARTIAL_COUNT];
+    Eigen::Map<Eigen::Matrix3d>(partial+TRANSFORM_PARTIAL_MATRIX)+=deltaFirst*((*pushSecond)-meanSecond).transpose();
 
 }
 
-void Transform::resetCorrelation(){
+void Transform::resetCorrelation(int threads){
 
     // Reset correlation matrix
     correlation=Eigen::Matrix3d::Zero();
 
+    // Reset partial correlation matrices
+    partials.resize(threads*TRANSFORM_PARTIAL_STRIDE, 0.);
+    for(unsigned int i(0); i<partials.size(); i+=TRANSFORM_PARTIAL_STRIDE){
+        Eigen::Map<Eigen::Matrix3d>(partials.data()+i+TRANSFORM_PARTIAL_MATRIX).setZero();
+    }
+
 }
 
-void Transform::resetCentroid(){
+void Transform::resetCentroid(int threads){
 
     // Reset centroids
     centerFirst =Eigen::Vector3d::Zero();
     centerSecond=Eigen::Vector3d::Zero();
     count=0;
 
+    // Reset partial accumulators - one slot per thread
+    partials.assign(threads*TRANSFORM_PARTIAL_STRIDE, 0.);
+
 }
 
 void Transform::computeCentroid(){
 
+    // Merge partial centroids
+    double merge(0.);
+    for(unsigned int i(0); i<partials.size(); i+=TRANSFORM_PARTIAL_STRIDE){
+        centerFirst +=Eigen::Map<Eigen::Vector3d>(partials.data()+i+TRANSFORM_PARTIAL_FIRST );
+        centerSecond+=Eigen::Map<Eigen::Vector3d>(partials.data()+i+TRANSFORM_PARTIAL_SECOND);
+        merge+=partials[i+TRANSFORM_PARTIAL_COUNT];
+    }
+    count=(unsigned int)merge;
+
     // Compute centroids
     centerFirst /=double(count);
     centerSecond/=double(count);
 
 }
 
+void Transform::computeCorrelation(){
+
+    // Merge partial correlation matrices
+    for(unsigned int i(0); i<partials.size(); i+=TRANSFORM_PARTIAL_STRIDE){
+        correlation+=Eigen::Map<Eigen::Matrix3d>(partials.data()+i+TRANSFORM_PARTIAL_MATRIX);
+    }
+
+}
+
+void Transform::computeMoments(){
+
+    // Merged count
+    double merge(0.);
+
+    // Merge partial means and co-moments - pairwise update of Chan et al.
+    for(unsigned int i(0); i<partials.size(); i+=TRANSFORM_PARTIAL_STRIDE){
+
+        // Partial count
+        double partial(partials[i+TRANSFORM_PARTIAL_COUNT]);
+        if(partial==0.){
+            continue;
+        }
+
+        // Partial means deviation to merged means
+        Eigen::Vector3d deltaFirst (Eigen::Map<Eigen::Vector3d>(partials.data()+i+TRANSFORM_PARTIAL_FIRST )-centerFirst );
+        Eigen::Vector3d deltaSecond(Eigen::Map<Eigen::Vector3d>(partials.data()+i+TRANSFORM_PARTIAL_SECOND)-centerSecond);
+
+        // Merge co-moment, means and count
+        correlation+=Eigen::Map<Eigen::Matrix3d>(partials.data()+i+TRANSFORM_PARTIAL_MATRIX)+(merge*partial/(merge+partial))*deltaFirst*deltaSecond.transpose();
+        centerFirst +=deltaFirst *(partial/(merge+partial));
+        centerSecond+=deltaSecond*(partial/(merge+partial));
+        merge+=partial;
+
+    }
+
+    // Assign merged count
+    count=(unsigned int)merge;
+
+}
+
 void Transform::computePose(){
 
     // Compute SVD decomposition
@@ -23,11 +23,20 @@
 
 // External includes
 #include <iostream>
+#include <vector>
+#include <omp.h>
 #include <Eigen/Dense>
 
 // Internal includes
 #include "framework-viewpoint.hpp"
 
+// Per-thread partial accumulator layout - centroids, count and correlation, padded against false sharing - running means and co-moment with moments
+#define TRANSFORM_PARTIAL_FIRST  (  0 )
+#define TRANSFORM_PARTIAL_SECOND (  3 )
+#define TRANSFORM_PARTIAL_COUNT  (  6 )
+#define TRANSFORM_PARTIAL_MATRIX (  7 )
+#define TRANSFORM_PARTIAL_STRIDE ( 24 )
+
 // Module object
 class Transform {
 
@@ -40,6 +49,7 @@ public: /* Need to be set back to private */
     Eigen::Matrix3d correlation;
     unsigned int count;
     double scale;
+    std::vector<double> partials;
 
 public:
     double getError();
@@ -50,9 +60,12 @@ public:
     void setScale();
     void pushCorrelation(Eigen::Vector3d * firstComponent, Eigen::Vector3d * secondComponent);
     void pushCentroid(Eigen::Vector3d * pushFirst, Eigen::Vector3d * pushSecond);
-    void resetCorrelation();
-    void resetCentroid();
+    void pushMoments(Eigen::Vector3d * pushFirst, Eigen::Vector3d * pushSecond);
+    void resetCorrelation(int threads);
+    void resetCentroid(int threads);
     void computeCentroid();
+    void computeCorrelation();
+    void computeMoments();
     void computePose();
     void computeFrame(Viewpoint * first, Viewpoint * second);
 
@@ -34,8 +34,8 @@ void utilesDirectories(std::string rootPath, std::string modeName) {
     fs::create_directories( rootPath.c_str() );
     fs::create_directory  ( modePath.c_str() );
 
-    // Specific directory
-    if (modeName == "dense" ){
+    // Specific directory - optical flow and features cache
+    if ((modeName == "dense") || (modeName == "sparse")){
 
         // Create path
         modePath = rootPath + "/cache";
@@ -65,27 +65,921 @@ Eigen::Vector3d utilesDirection(double x, double y, int width, int height){
 
 }
 
+//
+//  Image importation
+//
+
+int utilesDecodeMode(std::string modeName){
+
+    // Convert decoding mode name
+    if(modeName=="full"){
+        return UTILES_DECODE_FULL;
+    }else
+    if(modeName=="reduced"){
+        return UTILES_DECODE_REDUCED;
+    }else
+    if(modeName=="benchmark"){
+        return UTILES_DECODE_BENCHMARK;
+    }
+
+    // Send critical message
+    throw std::runtime_error("Error : unknown decoding mode " + modeName);
+
+}
+
+bool utilesImageSize(std::string imagePath, cv::Size * imageSize){
+
+    // Header buffer
+    unsigned char header[26];
+
+    // Marker segment length
+    unsigned int length(0);
+
+    // Image stream
+    std::ifstream stream(imagePath, std::ios::binary);
+
+    // Check stream
+    if(stream.read((char*)header, 2).good()==false){
+        return false;
+    }
+
+    // Bitmap header : dimension in DIB header
+    if((header[0]=='B')&&(header[1]=='M')){
+
+        // Read file and DIB header
+        if(stream.read((char*)header+2, 24).good()==false){
+            return false;
+        }
+
+        // Extract dimension - height sign encodes row order
+        int32_t width (int32_t(uint32_t(header[18])|(uint32_t(header[19])<<8)|(uint32_t(header[20])<<16)|(uint32_t(header[21])<<24)));
+        int32_t height(int32_t(uint32_t(header[22])|(uint32_t(header[23])<<8)|(uint32_t(header[24])<<16)|(uint32_t(header[25])<<24)));
+        (*imageSize)=cv::Size(width,std::abs(height));
+
+        // Return status
+        return true;
+
+    }
+
+    // JPEG header : dimension in start of frame segment
+    if((header[0]==0xFF)&&(header[1]==0xD8)){
+
+        // Parse marker segments
+        while(stream.read((char*)header, 4).good()){
+
+            // Check marker
+            if(header[0]!=0xFF){
+                return false;
+            }
+
+            // Segment length
+            length=(header[2]<<8)|header[3];
+
+            // Detect start of frame markers (excluding DHT, JPG and DAC)
+            if((header[1]>=0xC0)&&(header[1]<=0xCF)&&(header[1]!=0xC4)&&(header[1]!=0xC8)&&(header[1]!=0xCC)){
+
+                // Read precision and dimension
+                if(stream.read((char*)header, 5).good()==false){
+                    return false;
+                }
+
+                // Extract dimension
+                (*imageSize)=cv::Size((header[3]<<8)|header[4],(header[1]<<8)|header[2]);
+
+                // Return status
+                return true;
+
+            }
+
+            // Skip segment
+            stream.seekg(length-2, std::ios::cur);
+
+        }
+
+    }
+
+    // Return status
+    return false;
+
+}
+
+cv::Mat utilesImportBMP(std::string imagePath, int factor){
+
+    // Header buffer
+    unsigned char header[54];
+
+    // Image stream
+    std::ifstream stream(imagePath, std::ios::binary);
+
+    // Read file and DIB header
+    if(stream.read((char*)header, 54).good()==false){
+        return cv::Mat();
+    }
+
+    // Check signature
+    if((header[0]!='B')||(header[1]!='M')){
+        return cv::Mat();
+    }
+
+    // Extract header values
+    uint32_t offset     (uint32_t(header[10])|(uint32_t(header[11])<<8)|(uint32_t(header[12])<<16)|(uint32_t(header[13])<<24));
+    int32_t  width      (int32_t(uint32_t(header[18])|(uint32_t(header[19])<<8)|(uint32_t(header[20])<<16)|(uint32_t(header[21])<<24)));
+    int32_t  height     (int32_t(uint32_t(header[22])|(uint32_t(header[23])<<8)|(uint32_t(header[24])<<16)|(uint32_t(header[25])<<24)));
+    uint16_t depth      (header[28]|(header[29]<<8));
+    uint32_t compression(uint32_t(header[30])|(uint32_t(header[31])<<8)|(uint32_t(header[32])<<16)|(uint32_t(header[33])<<24));
+
+    // Only uncompressed 24 and 32 bits bitmaps are read directly
+    if((compression!=0)||((depth!=24)&&(depth!=32))||(width<=0)||(height==0)){
+        return cv::Mat();
+    }
+
+    // Row order - positive height for bottom-up bitmap
+    bool bottomUp(height>0);
+    height=std::abs(height);
+
+    // Pixel and row sizes
+    int pixel(depth/8);
+    size_t stride(((size_t(width)*depth+31)/32)*4);
+
+    // Reduced image dimension
+    int reducedWidth (width /factor);
+    int reducedHeight(height/factor);
+
+    // Check reduced dimension
+    if((reducedWidth==0)||(reducedHeight==0)){
+        return cv::Mat();
+    }
+
+    // Row buffer and reduced rows accumulator
+    std::vector<unsigned char> row(stride);
+    std::vector<uint32_t> accum(size_t(reducedWidth)*reducedHeight*3,0);
+
+    // Move to pixel array
+    stream.seekg(offset, std::ios::beg);
+
+    // Parse bitmap rows
+    for(int32_t i(0); i<height; i++){
+
+        // Read row
+        if(stream.read((char*)row.data(), stride).good()==false){
+            return cv::Mat();
+        }
+
+        // Compute reduced row - rows beyond the last complete block are dropped
+        int y((bottomUp ? height-1-i : i)/factor);
+        if(y>=reducedHeight){
+            continue;
+        }
+
+        // Accumulate row pixels in reduced row
+        uint32_t * accumRow(accum.data()+size_t(y)*reducedWidth*3);
+        for(int x(0); x<reducedWidth*factor; x++){
+            unsigned char * value(row.data()+x*pixel);
+            uint32_t * target(accumRow+(x/factor)*3);
+            target[0]+=value[0];
+            target[1]+=value[1];
+            target[2]+=value[2];
+        }
+
+    }
+
+    // Compute block averages - equivalent to area interpolation on integer factor
+    cv::Mat image(reducedHeight, reducedWidth, CV_8UC3);
+    uint32_t area(factor*factor);
+    for(int y(0); y<reducedHeight; y++){
+        uint32_t * accumRow(accum.data()+size_t(y)*reducedWidth*3);
+        unsigned char * imageRow(image.ptr<unsigned char>(y));
+        for(int x(0); x<reducedWidth*3; x++){
+            imageRow[x]=(accumRow[x]+area/2)/area;
+        }
+    }
+
+    // Return reduced image
+    return image;
+
+}
+
+cv::Mat utilesImportImage(std::string imagePath, double imageScale, int decodeMode){
+
+    // Imported image
+    cv::Mat image;
+
+    // Full resolution dimension
+    cv::Size imageSize;
+
+    // Decoding reduction factor
+    int factor(1);
+
+    // Full resolution decoding
+    if(decodeMode==UTILES_DECODE_FULL){
+
+        // Import and scale image
+        image = cv::imread(imagePath, cv::IMREAD_COLOR);
+        if(image.empty()==false){
+            cv::resize(image, image, cv::Size(), imageScale, imageScale, cv::INTER_AREA);
+        }
+
+        // Return imported image
+        return image;
+
+    }
+
+    // Benchmark timing
+    auto timeStart(std::chrono::steady_clock::now());
+
+    // Detect largest power of two reduction allowed by the scale factor
+    while((factor<8)&&(imageScale*factor*2.<=1.+1e-9)){
+        factor*=2;
+    }
+
+    // Full resolution dimension is needed to match the full decoding output size
+    if((factor>1)&&(utilesImageSize(imagePath, &imageSize)==true)){
+
+        // Image extension
+        std::string extension(fs::path(imagePath).extension().string());
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+        // Reduced decoding - JPEG through reduced DCT, bitmap through row reader
+        if((extension==".jpg")||(extension==".jpeg")){
+            image = cv::imread(imagePath, factor==2 ? cv::IMREAD_REDUCED_COLOR_2 : ( factor==4 ? cv::IMREAD_REDUCED_COLOR_4 : cv::IMREAD_REDUCED_COLOR_8 ) );
+        }else
+        if(extension==".bmp"){
+            image = utilesImportBMP(imagePath, factor);
+        }
+
+    }
+
+    // Fallback on full resolution decoding
+    if(image.empty()==true){
+        image = cv::imread(imagePath, cv::IMREAD_COLOR);
+        imageSize = image.size();
+    }
+
+    // Check status
+    if(image.empty()==true){
+        return image;
+    }
+
+    // Check reduced decoding consistency with header dimension (orientation metadata)
+    if((std::abs(image.cols*factor-imageSize.width)>=factor)||(std::abs(image.rows*factor-imageSize.height)>=factor)){
+        imageSize=cv::Size(image.cols*factor,image.rows*factor);
+    }
+
+    // Finishing resize on the remaining fraction - same output size as full decoding
+    cv::Size scaleSize(cv::saturate_cast<int>(imageSize.width*imageScale),cv::saturate_cast<int>(imageSize.height*imageScale));
+    if(image.size()!=scaleSize){
+        cv::resize(image, image, scaleSize, 0, 0, cv::INTER_AREA);
+    }
+
+    // Compare with full resolution decoding
+    if(decodeMode==UTILES_DECODE_BENCHMARK){
+
+        // Reduced decoding timing
+        auto timeReduced(std::chrono::steady_clock::now());
+
+        // Full resolution decoding
+        cv::Mat reference(utilesImportImage(imagePath, imageScale, UTILES_DECODE_FULL));
+
+        // Full decoding timing
+        auto timeFull(std::chrono::steady_clock::now());
+
+        // Display comparison - single stream operation as decoding may run on several threads
+        std::stringstream message;
+        message << "Decode " << fs::path(imagePath).filename() << " : factor " << factor
+                << " | reduced " << std::chrono::duration<double,std::milli>(timeReduced-timeStart).count() << " ms"
+                << " | full " << std::chrono::duration<double,std::milli>(timeFull-timeReduced).count() << " ms"
+                << " | mean difference " << ( reference.size()==image.size() ? cv::norm(reference, image, cv::NORM_L1)/double(image.total()*image.channels()) : -1. )
+                << std::endl;
+        std::cout << message.str();
+
+    }
+
+    // Return imported image
+    return image;
+
+}
+
 //
 //  Sparse features
 //
 
-void utilesAKAZEFeatures(cv::Mat* image, cv::Mat* mask, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc, float const threshold) {
+int utilesTilesMode(std::string tilesName){
+
+    // Cube faces reprojection
+    if(tilesName=="cube"){
+        return UTILES_TILES_CUBE;
+    }
+
+    // Equirectangular tiles count
+    if((tilesName.empty()==false)&&(std::all_of(tilesName.begin(), tilesName.end(), ::isdigit))){
+        return std::stoi(tilesName);
+    }
+
+    // Send critical message
+    throw std::runtime_error("Error : unknown tiles mode " + tilesName);
+
+}
+
+cv::Ptr<cv::AKAZE> utilesAKAZEDetector(float const threshold){
+
+    // AKAZE feature detector kept per thread
+    static thread_local cv::Ptr<cv::AKAZE> akaze(cv::AKAZE::create(cv::AKAZE::DESCRIPTOR_MLDB, 0, 3, threshold, 4, 4, cv::KAZE::DIFF_PM_G2));
+
+    // Update detector threshold
+    akaze->setThreshold(threshold);
+
+    // Return thread detector
+    return akaze;
+
+}
+
+void utilesCubeFrame(int face, Eigen::Vector3d * forward, Eigen::Vector3d * right, Eigen::Vector3d * down){
+
+    // Face axis and direction - faces ordered as +x, -x, +y, -y, +z, -z
+    *forward=Eigen::Vector3d::Zero();
+    (*forward)(face/2)=(face%2==0) ? 1. : -1.;
+
+    // Side faces - right along increasing longitude, down along increasing latitude as in the equirectangular image
+    if(face<4){
+        *down=Eigen::Vector3d(0.,0.,1.);
+        *right=down->cross(*forward);
+
+    // Polar faces
+    }else{
+        *right=Eigen::Vector3d(0.,1.,0.);
+        *down=forward->cross(*right);
+    }
+
+}
+
+void utilesAKAZECube(cv::Mat* image, cv::Mat* mask, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc, float const threshold){
+
+    // Reprojection maps shared by all callers - rebuilt on image size change only
+    static std::mutex cubeMutex;
+    static std::shared_ptr<std::vector<cv::Mat>> cubeMaps;
+    static cv::Size cubeSize;
+
+    // Image dimension
+    int width(image->cols);
+    int height(image->rows);
+
+    // Face core size - same mean solid angle per pixel as the equirectangular equator, about two thirds of its pixels
+    int face(std::lround(width/std::sqrt(6.*M_PI)));
+
+    // Face size with overlap margin and its tangent half extent
+    int size(face+2*UTILES_CUBE_MARGIN);
+    double extent(double(size)/face);
+
+    // Retrieve or build reprojection maps
+    std::shared_ptr<std::vector<cv::Mat>> maps;
+    {
+        std::lock_guard<std::mutex> lock(cubeMutex);
+        if((!cubeMaps)||(cubeSize!=image->size())){
+
+            // Maps storage - longitude and latitude pixel coordinates of each face
+            auto build(std::make_shared<std::vector<cv::Mat>>(12));
+
+            // Parsing faces
+            for(int f(0); f<6; f++){
+
+                // Face frame
+                Eigen::Vector3d forward, right, down;
+                utilesCubeFrame(f, &forward, &right, &down);
+
+                // Allocate face maps
+                (*build)[2*f  ]=cv::Mat(size, size, CV_32FC1);
+                (*build)[2*f+1]=cv::Mat(size, size, CV_32FC1);
+
+                // Equirectangular coordinates of face pixels
+                # pragma omp parallel for
+                for(int j=0; j<size; j++){
+                    for(int i(0); i<size; i++){
+                        Eigen::Vector3d d((forward+(((i+.5)/size)*2.-1.)*extent*right+(((j+.5)/size)*2.-1.)*extent*down).normalized());
+                        double lamda(std::atan2(d(1),d(0)));
+                        if(lamda<0.) lamda+=2.*M_PI;
+                        (*build)[2*f  ].at<float>(j,i)=(lamda/(2.*M_PI))*width;
+                        (*build)[2*f+1].at<float>(j,i)=(std::asin(d(2))/M_PI+0.5)*(height-1);
+                    }
+                }
+
+            }
+
+            // Publish maps
+            cubeMaps=build;
+            cubeSize=image->size();
+
+        }
+        maps=cubeMaps;
+    }
+
+    // Faces features and descriptors
+    std::vector<std::vector<cv::KeyPoint>> faceKeypoints(6);
+    std::vector<cv::Mat> faceDesc(6);
+
+    // Parsing faces
+    # pragma omp parallel for schedule(dynamic)
+    for(int f=0; f<6; f++){
+
+        // Face frame
+        Eigen::Vector3d forward, right, down;
+        utilesCubeFrame(f, &forward, &right, &down);
+
+        // Reproject mask and skip fully masked faces
+        cv::Mat faceMask;
+        if(mask->empty()==false){
+            cv::remap(*mask, faceMask, (*maps)[2*f], (*maps)[2*f+1], cv::INTER_NEAREST, cv::BORDER_CONSTANT);
+            if(cv::countNonZero(faceMask)==0){
+                continue;
+            }
+        }
+
+        // Reproject image - wrap in longitude
+        cv::Mat faceImage;
+        cv::remap(*image, faceImage, (*maps)[2*f], (*maps)[2*f+1], cv::INTER_LINEAR, cv::BORDER_WRAP);
+
+        // Face features and descriptors
+        std::vector<cv::KeyPoint> keys;
+        cv::Mat descs;
+
+        // Compute face features and their descriptor
+        utilesAKAZEDetector(threshold)->detectAndCompute(faceImage, faceMask, keys, descs);
+
+        // Keep features owned by the face - dominant axis of the bearing, no duplicates across overlaps
+        for(unsigned int i(0); i<keys.size(); i++){
+
+            // Tangent coordinates and bearing
+            double u((((keys[i].pt.x+.5)/size)*2.-1.)*extent);
+            double v((((keys[i].pt.y+.5)/size)*2.-1.)*extent);
+            Eigen::Vector3d d(forward+u*right+v*down);
+
+            // Ownership condition
+            int axis;
+            d.cwiseAbs().maxCoeff(&axis);
+            if((axis!=f/2)||((d(axis)>0.)!=(f%2==0))){
+                continue;
+            }
+
+            // Equirectangular coordinates
+            d.normalize();
+            double lamda(std::atan2(d(1),d(0)));
+            if(lamda<0.) lamda+=2.*M_PI;
+            keys[i].pt.x=std::min(float((lamda/(2.*M_PI))*width), std::nextafter(float(width), 0.f));
+            keys[i].pt.y=(std::asin(d(2))/M_PI+0.5)*(height-1);
+
+            // Feature size in equirectangular latitude pixels
+            keys[i].size*=((2.*extent/size)/(1.+u*u+v*v))/(M_PI/(height-1));
+
+            // Keep feature
+            faceKeypoints[f].push_back(keys[i]);
+            faceDesc[f].push_back(descs.row(i));
+
+        }
+
+    }
+
+    // Merge faces in order
+    keypoints->clear();
+    *desc=cv::Mat();
+    for(int f(0); f<6; f++){
+        keypoints->insert(keypoints->end(), faceKeypoints[f].begin(), faceKeypoints[f].end());
+        if(faceDesc[f].empty()==false){
+            desc->push_back(faceDesc[f]);
+        }
+    }
+
+}
+
+void utilesAKAZEFeatures(cv::Mat* image, cv::Mat* mask, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc, float const threshold, int tiles) {
+
+    // Cube faces reprojection
+    if(tiles==UTILES_TILES_CUBE){
+        utilesAKAZECube(image, mask, keypoints, desc, threshold);
+        return;
+    }
+
+    // Check tiling
+    if(tiles<=1){
+
+        // Compute feature and their descriptor
+        utilesAKAZEDetector(threshold)->detectAndCompute(*image, *mask, *keypoints, *desc);
+
+        return;
+
+    }
+
+    // Image dimension
+    int width(image->cols);
+    int height(image->rows);
+
+    // Tiles grid - longitude tiles twice the latitude bands keep tiles square
+    int tilesLon(tiles);
+    int tilesLat(std::max(1,tiles/2));
+
+    // Padded image and mask - longitude wrap-around
+    cv::Mat padImage, padMask;
+    cv::copyMakeBorder(*image, padImage, 0, 0, UTILES_TILE_MARGIN, UTILES_TILE_MARGIN, cv::BORDER_WRAP);
+    if(mask->empty()==false){
+        cv::copyMakeBorder(*mask, padMask, 0, 0, UTILES_TILE_MARGIN, UTILES_TILE_MARGIN, cv::BORDER_WRAP);
+    }
+
+    // Tiles features and descriptors
+    std::vector<std::vector<cv::KeyPoint>> tileKeypoints(tilesLon*tilesLat);
+    std::vector<cv::Mat> tileDesc(tilesLon*tilesLat);
+
+    // Parsing tiles
+    # pragma omp parallel for schedule(dynamic)
+    for(int t=0; t<tilesLon*tilesLat; t++){
+
+        // Tile core - cores partition the image
+        int x0(((t%tilesLon)*width)/tilesLon), x1((((t%tilesLon)+1)*width)/tilesLon);
+        int y0(((t/tilesLon)*height)/tilesLat), y1((((t/tilesLon)+1)*height)/tilesLat);
+
+        // Skip fully masked tiles
+        if((mask->empty()==false)&&(cv::countNonZero((*mask)(cv::Rect(x0, y0, x1-x0, y1-y0)))==0)){
+            continue;
+        }
 
-    // Instance AKAZE feature detector
-    cv::Ptr<cv::AKAZE> akaze = cv::AKAZE::create(cv::AKAZE::DESCRIPTOR_MLDB, 0, 3, threshold, 4, 4, cv::KAZE::DIFF_PM_G2);
+        // Tile region with margin - padded image coordinates
+        int py0(std::max(0,y0-UTILES_TILE_MARGIN));
+        int py1(std::min(height,y1+UTILES_TILE_MARGIN));
+        cv::Rect region(x0, py0, x1-x0+2*UTILES_TILE_MARGIN, py1-py0);
 
-    // Compute feature and their descriptor
-    akaze->detectAndCompute(*image, *mask, *keypoints, *desc);
+        // Tile features and descriptors
+        std::vector<cv::KeyPoint> keys;
+        cv::Mat descs;
+
+        // Compute tile features and their descriptor
+        utilesAKAZEDetector(threshold)->detectAndCompute(padImage(region), padMask.empty() ? cv::Mat() : padMask(region), keys, descs);
+
+        // Keep features owned by the tile core - no duplicates across borders
+        for(unsigned int i(0); i<keys.size(); i++){
+
+            // Image coordinates
+            keys[i].pt.x+=x0-UTILES_TILE_MARGIN;
+            keys[i].pt.y+=py0;
+
+            // Ownership condition
+            if((keys[i].pt.x>=x0)&&(keys[i].pt.x<x1)&&(keys[i].pt.y>=y0)&&(keys[i].pt.y<y1)){
+                tileKeypoints[t].push_back(keys[i]);
+                tileDesc[t].push_back(descs.row(i));
+            }
+
+        }
+
+    }
+
+    // Merge tiles in order
+    keypoints->clear();
+    *desc=cv::Mat();
+    for(int t(0); t<tilesLon*tilesLat; t++){
+        keypoints->insert(keypoints->end(), tileKeypoints[t].begin(), tileKeypoints[t].end());
+        if(tileDesc[t].empty()==false){
+            desc->push_back(tileDesc[t]);
+        }
+    }
+
+}
+
+void utilesFeaturesBudget(std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc, cv::Size size, unsigned int budget){
+
+    // Check budget
+    if(keypoints->size()<=budget){
+        return;
+    }
+
+    // Equal-area buckets on the sphere
+    static SphereGrid grid(UTILES_BUDGET_BANDS, false, false);
+
+    // Features per bucket
+    std::vector<std::vector<unsigned int>> buckets(grid.getCount());
+
+    // Selected features
+    std::vector<unsigned int> selected;
+
+    // Assign features to buckets
+    for(unsigned int i(0); i<keypoints->size(); i++){
+        buckets[grid.getCell((*keypoints)[i].pt.x/size.width, (*keypoints)[i].pt.y/(size.height-1))].push_back(i);
+    }
+
+    // Sort bucket features by decreasing response
+    for(auto & bucket: buckets){
+        std::sort(bucket.begin(), bucket.end(), [keypoints](unsigned int a, unsigned int b){
+            return (*keypoints)[a].response>(*keypoints)[b].response;
+        });
+    }
+
+    // Search smallest per bucket quota reaching the budget
+    unsigned int quota(0), count(0);
+    while(count<budget){
+        quota ++;
+        count=0;
+        for(auto & bucket: buckets){
+            count+=std::min(size_t(quota), bucket.size());
+        }
+    }
+
+    // Select features under quota - the weakest of the last rank are dropped above budget
+    std::vector<unsigned int> lastRank;
+    for(auto & bucket: buckets){
+        for(unsigned int j(0); j<std::min(size_t(quota), bucket.size()); j++){
+            if(j+1<quota){
+                selected.push_back(bucket[j]);
+            }else{
+                lastRank.push_back(bucket[j]);
+            }
+        }
+    }
+    std::sort(lastRank.begin(), lastRank.end(), [keypoints](unsigned int a, unsigned int b){
+        return (*keypoints)[a].response>(*keypoints)[b].response;
+    });
+    selected.insert(selected.end(), lastRank.begin(), lastRank.begin()+(budget-selected.size()));
+
+    // Keep original features order
+    std::sort(selected.begin(), selected.end());
+
+    // Compose selected features and descriptors
+    std::vector<cv::KeyPoint> keepKeypoints(selected.size());
+    cv::Mat keepDesc(selected.size(), desc->cols, desc->type());
+    for(unsigned int i(0); i<selected.size(); i++){
+        keepKeypoints[i]=(*keypoints)[selected[i]];
+        memcpy(keepDesc.ptr(i), desc->ptr(selected[i]), desc->cols*desc->elemSize());
+    }
+
+    // Assign selected features
+    keypoints->swap(keepKeypoints);
+    *desc=keepDesc;
+
+}
+
+uint64_t utilesHashBytes(uint64_t hash, void const * data, size_t size){
+
+    // Fold bytes into hash - FNV-1a
+    unsigned char const * bytes((unsigned char const *)data);
+    for(size_t i(0); i<size; i++){
+        hash=(hash^bytes[i])*UTILES_HASH_PRIME;
+    }
+
+    // Return hash
+    return hash;
+
+}
+
+uint64_t utilesHashMat(uint64_t hash, cv::Mat* matrix){
+
+    // Matrix layout
+    int32_t layout[3] = { matrix->rows, matrix->cols, matrix->type() };
+
+    // Fold matrix layout
+    hash=utilesHashBytes(hash, layout, sizeof(layout));
+
+    // Fold matrix content - row by row on non-continuous matrix for identical hash
+    if(matrix->isContinuous()){
+        hash=utilesHashBytes(hash, matrix->data, matrix->total()*matrix->elemSize());
+    }else{
+        for(int i(0); i<matrix->rows; i++){
+            hash=utilesHashBytes(hash, matrix->ptr(i), matrix->cols*matrix->elemSize());
+        }
+    }
+
+    // Return hash
+    return hash;
 
 }
 
-void utilesGMSMatcher(std::vector<cv::KeyPoint>* k1, cv::Mat* d1, cv::Size s1, std::vector<cv::KeyPoint>* k2, cv::Mat* d2, cv::Size s2, std::vector<cv::DMatch> *matches) {
+std::string utilesFeaturesKey(cv::Mat* image, cv::Mat* mask, float const threshold, int tiles){
+
+    // Key components : image content and layout, mask content, detector threshold and tiling - cube faces as a reserved value
+    int32_t tiling(tiles==UTILES_TILES_CUBE ? UTILES_TILES_CUBE : (tiles>1 ? tiles : 0));
+    uint64_t key(UTILES_HASH_BASIS);
+    key=utilesHashMat(key, image);
+    key=utilesHashMat(key, mask);
+    key=utilesHashBytes(key, &threshold, sizeof(float));
+    key=utilesHashBytes(key, &tiling, sizeof(int32_t));
+
+    // Compose key string
+    std::stringstream keyStream;
+    keyStream << std::hex << std::setfill('0') << std::setw(16) << key;
+
+    // Return key string
+    return keyStream.str();
+
+}
+
+bool utilesFeaturesRead(std::string cachePath, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc){
+
+    // File status
+    struct stat fileStat;
+
+    // Open cache file
+    int fileDescriptor(open(cachePath.c_str(), O_RDONLY));
+    if(fileDescriptor<0){
+        return false;
+    }
+
+    // Check file size against header
+    if((fstat(fileDescriptor, &fileStat)<0)||(size_t(fileStat.st_size)<6*sizeof(uint32_t))){
+        close(fileDescriptor);
+        return false;
+    }
+
+    // Map cache file
+    void * fileMap(mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0));
+    close(fileDescriptor);
+    if(fileMap==MAP_FAILED){
+        return false;
+    }
+
+    // Header : magic, version, features count, descriptor columns and type, reserved
+    uint32_t const * header((uint32_t const *)fileMap);
+    size_t count(header[2]);
+    size_t cols(header[3]);
+    int type(header[4]);
+
+    // Check header consistency and file size - truncated or corrupted files rejected before reaching the content
+    if((header[0]!=UTILES_CACHE_MAGIC)||(header[1]!=UTILES_CACHE_VERSION)||(type!=CV_MAT_TYPE(type))||(size_t(fileStat.st_size)!=6*sizeof(uint32_t)+count*7*sizeof(float)+count*cols*CV_ELEM_SIZE(type))){
+        munmap(fileMap, fileStat.st_size);
+        return false;
+    }
+
+    // Keypoint records and descriptor array
+    float const * records((float const *)(header+6));
+    unsigned char const * array((unsigned char const *)(records+count*7));
+
+    // Keypoint octave and class
+    int32_t octave(0), classId(0);
+
+    // Import keypoints
+    keypoints->resize(count);
+    for(size_t i(0); i<count; i++, records+=7){
+        memcpy(&octave , records+5, sizeof(int32_t));
+        memcpy(&classId, records+6, sizeof(int32_t));
+        (*keypoints)[i]=cv::KeyPoint(records[0], records[1], records[2], records[3], records[4], octave, classId);
+    }
+
+    // Import descriptors
+    desc->create(count, cols, type);
+    if(count>0){
+        memcpy(desc->data, array, count*cols*CV_ELEM_SIZE(type));
+    }
+
+    // Release mapping
+    munmap(fileMap, fileStat.st_size);
+
+    // Return status
+    return true;
+
+}
+
+void utilesFeaturesWrite(std::string cachePath, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc){
+
+    // Header : magic, version, features count, descriptor columns and type, reserved
+    uint32_t header[6] = { UTILES_CACHE_MAGIC, UTILES_CACHE_VERSION, uint32_t(keypoints->size()), uint32_t(desc->cols), uint32_t(desc->type()), 0 };
+
+    // Keypoint record
+    float record[7];
+
+    // Temporary file - unique per process and thread, renamed once complete for concurrent writers
+    std::stringstream writeStream;
+    writeStream << cachePath << ".tmp" << getpid() << "-" << std::this_thread::get_id();
+    std::string writePath(writeStream.str());
+
+    // Create cache stream
+    std::ofstream stream(writePath, std::ios::binary);
+    if(stream.is_open()==false){
+        std::cerr << "Warning : unable to create features cache file" << std::endl;
+        return;
+    }
+
+    // Export header
+    stream.write((char*)header, sizeof(header));
+
+    // Export keypoints
+    for(auto & keypoint: *keypoints){
+        record[0]=keypoint.pt.x;
+        record[1]=keypoint.pt.y;
+        record[2]=keypoint.size;
+        record[3]=keypoint.angle;
+        record[4]=keypoint.response;
+        memcpy(record+5, &keypoint.octave  , sizeof(int32_t));
+        memcpy(record+6, &keypoint.class_id, sizeof(int32_t));
+        stream.write((char*)record, sizeof(record));
+    }
+
+    // Export descriptors
+    for(int i(0); i<desc->rows; i++){
+        stream.write(desc->ptr<char>(i), desc->cols*desc->elemSize());
+    }
+
+    // Delete cache stream
+    stream.close();
+
+    // Check export - incomplete file discarded
+    std::error_code fileError;
+    if(stream.good()==false){
+        std::cerr << "Warning : unable to export features cache file" << std::endl;
+        fs::remove(writePath, fileError);
+        return;
+    }
+
+    // Publish cache file
+    fs::rename(writePath, cachePath, fileError);
+    if(fileError){
+        std::cerr << "Warning : unable to publish features cache file (" << fileError.message() << ")" << std::endl;
+        fs::remove(writePath, fileError);
+    }
+
+}
+
+void utilesAKAZECache(cv::Mat* image, cv::Mat* mask, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc, float const threshold, int tiles, std::string cacheFolder){
+
+    // Cache file path
+    std::string cachePath(cacheFolder + "/" + utilesFeaturesKey(image, mask, threshold, tiles) + ".akaze");
+
+    // Import cached features
+    if(utilesFeaturesRead(cachePath, keypoints, desc)==true){
+        return;
+    }
+
+    // Compute image features and descriptors
+    utilesAKAZEFeatures(image, mask, keypoints, desc, threshold, tiles);
+
+    // Export features to cache
+    utilesFeaturesWrite(cachePath, keypoints, desc);
+
+}
+
+void utilesGMSMatcher(std::vector<cv::KeyPoint>* k1, cv::Mat* d1, cv::Size s1, std::vector<cv::KeyPoint>* k2, cv::Mat* d2, cv::Size s2, std::vector<cv::DMatch> *matches, int matcherMode, int gmsGrid, double gmsRatio, int * gmsHypothesis, std::ostream & logStream) {
 
     // Raw matches
     std::vector<cv::DMatch> matches_all;
 
-    // Instance brute-force matcher
-    cv::BFMatcher matcher(cv::NORM_HAMMING, true);
+    // Clear previous matches
+    matches->clear();
+
+    // Features matching
+    if(matcherMode==MATCHER_MODE_BRUTE){
+
+        // Instance brute-force matcher
+        cv::BFMatcher matcher(cv::NORM_HAMMING, true);
+
+        // Brute-force matching with cross-check
+        matcher.match(*d1, *d2, matches_all);
+
+    }else{
+
+        // Benchmark timing
+        auto timeStart(std::chrono::steady_clock::now());
+
+        // Single pass bidirectional matching
+        matcherHamming(d1, d2, &matches_all);
+
+        // Compare with brute-force matcher
+        if(matcherMode==MATCHER_MODE_BENCHMARK){
+
+            // Reference matches
+            std::vector<cv::DMatch> matches_ref;
+
+            // Hamming matcher timing
+            auto timeHamming(std::chrono::steady_clock::now());
+
+            // Brute-force matching with cross-check
+            cv::BFMatcher matcher(cv::NORM_HAMMING, true);
+            matcher.match(*d1, *d2, matches_ref);
+
+            // Brute-force matcher timing
+            auto timeBrute(std::chrono::steady_clock::now());
+
+            // Count identical matches
+            std::vector<int> reference(k1->size(), -1);
+            unsigned int identical(0);
+            for(auto & match: matches_ref){
+                reference[match.queryIdx]=match.trainIdx;
+            }
+            for(auto & match: matches_all){
+                if(reference[match.queryIdx]==match.trainIdx) identical++;
+            }
+
+            // Display comparison
+            logStream << "Matcher : hamming " << std::chrono::duration<double,std::milli>(timeHamming-timeStart).count() << " ms"
+                      << " | brute " << std::chrono::duration<double,std::milli>(timeBrute-timeHamming).count() << " ms"
+                      << " | identical " << identical << "/" << matches_ref.size() << " | ";
+
+        }
+
+    }
+
+    // Display matching summary
+    logStream << "Feat 1 : " << k1->size() << " | Feat 2 : " << k2->size() << " | Match : " << matches_all.size();
+
+    // GMS filtering on matches
+    utilesGMSFilter(k1, s1, k2, s2, &matches_all, matches, gmsGrid, gmsRatio, gmsHypothesis, logStream);
+
+    // Display matches filtering summary
+    logStream << " | Filter : " << matches->size() << std::endl;
+
+}
+
+void utilesGMSFilter(std::vector<cv::KeyPoint>* k1, cv::Size s1, std::vector<cv::KeyPoint>* k2, cv::Size s2, std::vector<cv::DMatch> *candidates, std::vector<cv::DMatch> *matches, int gmsGrid, double gmsRatio, int * gmsHypothesis, std::ostream & logStream) {
 
     // GMS matcher inliers
 	std::vector<bool> vbInliers;
@@ -93,28 +987,77 @@ void utilesGMSMatcher(std::vector<cv::KeyPoint>* k1, cv::Mat* d1, cv::Size s1, s
     // Clear previous matches
     matches->clear();
 
-    // Features matching
-	matcher.match(*d1, *d2, matches_all);
+    // Spherical statistics grid - single hypothesis
+    if(gmsGrid==SPHERE_MODE_SPHERICAL){
 
-    // Display matching summary
-    std::cerr << "Feat 1 : " << k1->size() << " | Feat 2 : " << k2->size() << " | Match : " << matches_all.size();
+        // Spherical filter kept per thread along the sequence
+        static thread_local SphereFilter sphere(SPHERE_BANDS);
+
+        // Visited cells count
+        unsigned long visited(0);
+
+        // Filter matches on the spherical grid
+        sphere.filter(k1, s1, k2, s2, candidates, matches, &visited);
+
+        // Display visited cells summary
+        logStream << " | Cells : " << visited;
+
+        return;
+
+    }
+
+    // GMS engine kept per thread along the sequence
+    static thread_local gms_matcher gms;
 
 	// GMS filtering on matches
-	gms_matcher gms(*k1, s1, *k2, s2, matches_all);
+	gms.Initialize(*k1, s1, *k2, s2, *candidates);
+
+    // Retrieve inliers flags - exhaustive or prior hypothesis first
+    if(gmsRatio>0.){
+
+        // Evaluated hypotheses count
+        int gmsEvaluated(0);
+
+        // Prior hypothesis with early stop
+        gms.GetInlierMaskPrior(vbInliers, *gmsHypothesis, gmsRatio, gmsEvaluated);
 
-    // Retrieve inliers flags
-	gms.GetInlierMask(vbInliers, true, true);
+        // Display hypotheses summary
+        logStream << " | Hypothesis : " << *gmsHypothesis << " (" << gmsEvaluated << "/" << GMS_HYPOTHESES << ")";
+
+    }else{
+	    gms.GetInlierMask(vbInliers, true, true);
+    }
 
     // Filter matches based on GMS filter
 	for (size_t i = 0; i < vbInliers.size(); ++i) {
 
         // Detect inlier and push to the filtered match array
-		if (vbInliers[i] == true) matches->push_back(matches_all[i]);
+		if (vbInliers[i] == true) matches->push_back((*candidates)[i]);
 
 	}
 
+}
+
+bool utilesGuidedMatcher(std::vector<cv::KeyPoint>* k1, cv::Mat* d1, std::vector<Eigen::Vector3d>* b1, cv::Size s1, std::vector<cv::KeyPoint>* k2, cv::Mat* d2, std::vector<Eigen::Vector3d>* b2, cv::Size s2, double window, std::vector<cv::DMatch> *matches, int gmsGrid, double gmsRatio, int * gmsHypothesis, std::ostream & logStream) {
+
+    // Raw matches
+    std::vector<cv::DMatch> matches_all;
+
+    // Window restricted matching on predicted bearings
+    unsigned long comparisons(matcherGuided(d1, b1, d2, b2, window, &matches_all));
+
+    // Display matching summary
+    logStream << "Guided : " << comparisons << "/" << (unsigned long)(k1->size())*k2->size() << " comparisons | ";
+    logStream << "Feat 1 : " << k1->size() << " | Feat 2 : " << k2->size() << " | Match : " << matches_all.size();
+
+    // GMS filtering on matches
+    utilesGMSFilter(k1, s1, k2, s2, &matches_all, matches, gmsGrid, gmsRatio, gmsHypothesis, logStream);
+
     // Display matches filtering summary
-    std::cerr << " | Filter : " << matches->size() << std::endl;
+    logStream << " | Filter : " << matches->size() << std::endl;
+
+    // Check guided matching consistency - prediction considered as failed otherwise
+    return matches->size()>=UTILES_GUIDED_MINIMUM;
 
 }
 
@@ -167,6 +1110,71 @@ double utilesDetectMotion(std::vector<cv::KeyPoint> *kp1, std::vector<cv::KeyPoi
 
 }
 
+cv::Mat utilesThumbnail(cv::Mat * image, int width){
+
+    // Thumbnail image
+    cv::Mat thumbnail;
+
+    // Convert to grayscale
+    cv::cvtColor(*image, thumbnail, cv::COLOR_BGR2GRAY);
+
+    // Downsample with area averaging
+    cv::resize(thumbnail, thumbnail, cv::Size(width, std::max(1, (width*image->rows)/image->cols)), 0, 0, cv::INTER_AREA);
+
+    // Return thumbnail
+    return thumbnail;
+
+}
+
+double utilesThumbnailMotion(cv::Mat * thumbLast, cv::Mat * thumbNew, cv::Mat * thumbMask){
+
+    // Tracked points
+    std::vector<cv::Point2f> pointLast, pointNew;
+
+    // Tracking status and error
+    std::vector<unsigned char> status;
+    std::vector<float> error;
+
+    // Angular displacements
+    std::vector<double> displacement;
+
+    // Sample points on a regular grid inside the mask
+    for(int y(UTILES_GATE_STEP/2); y<thumbLast->rows; y+=UTILES_GATE_STEP){
+        for(int x(UTILES_GATE_STEP/2); x<thumbLast->cols; x+=UTILES_GATE_STEP){
+            if(thumbMask->empty()||(thumbMask->at<uint8_t>(y,x)!=0)){
+                pointLast.push_back(cv::Point2f(x,y));
+            }
+        }
+    }
+
+    // Check sampled points
+    if(pointLast.size()<UTILES_GATE_MINIMUM){
+        return std::numeric_limits<double>::max();
+    }
+
+    // Sparse optical flow on a shallow pyramid
+    cv::calcOpticalFlowPyrLK(*thumbLast, *thumbNew, pointLast, pointNew, status, error, cv::Size(9,9), 2);
+
+    // Compute angular displacement of tracked points
+    for(unsigned int i(0); i<pointLast.size(); i++){
+        if(status[i]!=0){
+            Eigen::Vector3d p1(utilesDirection(pointLast[i].x, pointLast[i].y, thumbLast->cols, thumbLast->rows));
+            Eigen::Vector3d p2(utilesDirection(pointNew[i].x, pointNew[i].y, thumbNew->cols, thumbNew->rows));
+            displacement.push_back(std::acos(std::max(-1.,std::min(1.,p1.dot(p2)))));
+        }
+    }
+
+    // Check tracked points - undecided motion otherwise
+    if(displacement.size()<UTILES_GATE_MINIMUM){
+        return std::numeric_limits<double>::max();
+    }
+
+    // Return median angular displacement
+    std::nth_element(displacement.begin(), displacement.begin()+displacement.size()/2, displacement.end());
+    return displacement[displacement.size()/2];
+
+}
+
 //
 //  Dense features
 //
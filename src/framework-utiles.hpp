@@ -24,17 +24,67 @@
 // External includes
 #include <iostream>
 #include <cmath>
+#include <cctype>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <string>
+#include <fstream>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
 #include <experimental/filesystem>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <Eigen/Core>
+#include <Eigen/Geometry>
 #include <opencv4/opencv2/core.hpp>
 
 // Internal includes
 #include "gms_matcher.hpp"
+#include "framework-matcher.hpp"
+#include "framework-sphere.hpp"
 
 // Namespaces
 namespace fs = std::experimental::filesystem;
 
+// Features cache file signature and version
+#define UTILES_CACHE_MAGIC      ( 0x46534653 ) /* SFSF */
+#define UTILES_CACHE_VERSION    ( 1 )
+
+// Features cache key hash - 64 bits FNV-1a offset basis and prime
+#define UTILES_HASH_BASIS       ( 0xcbf29ce484222325ULL )
+#define UTILES_HASH_PRIME       ( 0x00000100000001b3ULL )
+
+// Image decoding modes
+#define UTILES_DECODE_FULL      ( 0 ) /* Full resolution decoding followed by resize */
+#define UTILES_DECODE_REDUCED   ( 1 ) /* Reduced resolution decoding followed by finishing resize */
+#define UTILES_DECODE_BENCHMARK ( 2 ) /* Reduced resolution decoding compared against full decoding */
+
+// Guided matching minimum filtered matches before exhaustive fallback
+#define UTILES_GUIDED_MINIMUM   ( 64 )
+
+// Tiled features extraction margin around tile cores
+#define UTILES_TILE_MARGIN      ( 64 )
+
+// Features tiling mode - cube faces reprojection instead of equirectangular tiles
+#define UTILES_TILES_CUBE       ( -1 )
+
+// Cube faces overlap margin around face cores
+#define UTILES_CUBE_MARGIN      ( 32 )
+
+// Features budget buckets latitude bands
+#define UTILES_BUDGET_BANDS     ( 10 )
+
+// Motion gate thumbnail width, sampling step and minimum tracked points
+#define UTILES_GATE_WIDTH       ( 256 )
+#define UTILES_GATE_STEP        ( 8 )
+#define UTILES_GATE_MINIMUM     ( 16 )
+
 template<typename T> std::pair<bool, int> findInVector(const std::vector<T> &vecOfElements, const T &element) {
 
     std::pair<bool, int> result;
@@ -58,11 +108,39 @@ void utilesDirectories(std::string rootPath, std::string modeName);
 
 Eigen::Vector3d utilesDirection(double x, double y, int width, int height);
 
-void utilesAKAZEFeatures(cv::Mat* image, cv::Mat* mask, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc, float const threshold);
+int utilesDecodeMode(std::string modeName);
+
+bool utilesImageSize(std::string imagePath, cv::Size * imageSize);
+
+cv::Mat utilesImportBMP(std::string imagePath, int factor);
+
+cv::Mat utilesImportImage(std::string imagePath, double imageScale, int decodeMode);
+
+int utilesTilesMode(std::string tilesName);
+
+cv::Ptr<cv::AKAZE> utilesAKAZEDetector(float const threshold);
+void utilesCubeFrame(int face, Eigen::Vector3d * forward, Eigen::Vector3d * right, Eigen::Vector3d * down);
+void utilesAKAZECube(cv::Mat* image, cv::Mat* mask, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc, float const threshold);
+void utilesAKAZEFeatures(cv::Mat* image, cv::Mat* mask, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc, float const threshold, int tiles);
+
+void utilesFeaturesBudget(std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc, cv::Size size, unsigned int budget);
+uint64_t utilesHashBytes(uint64_t hash, void const * data, size_t size);
+uint64_t utilesHashMat(uint64_t hash, cv::Mat* matrix);
+std::string utilesFeaturesKey(cv::Mat* image, cv::Mat* mask, float const threshold, int tiles);
+
+bool utilesFeaturesRead(std::string cachePath, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc);
+
+void utilesFeaturesWrite(std::string cachePath, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc);
+
+void utilesAKAZECache(cv::Mat* image, cv::Mat* mask, std::vector<cv::KeyPoint>* keypoints, cv::Mat* desc, float const threshold, int tiles, std::string cacheFolder);
 
-void utilesGMSMatcher(std::vector<cv::KeyPoint>* k1, cv::Mat* d1, cv::Size s1, std::vector<cv::KeyPoint>* k2, cv::Mat* d2, cv::Size s2, std::vector<cv::DMatch> *matches);
+void utilesGMSMatcher(std::vector<cv::KeyPoint>* k1, cv::Mat* d1, cv::Size s1, std::vector<cv::KeyPoint>* k2, cv::Mat* d2, cv::Size s2, std::vector<cv::DMatch> *matches, int matcherMode, int gmsGrid, double gmsRatio, int * gmsHypothesis, std::ostream & logStream);
+void utilesGMSFilter(std::vector<cv::KeyPoint>* k1, cv::Size s1, std::vector<cv::KeyPoint>* k2, cv::Size s2, std::vector<cv::DMatch> *candidates, std::vector<cv::DMatch> *matches, int gmsGrid, double gmsRatio, int * gmsHypothesis, std::ostream & logStream);
+bool utilesGuidedMatcher(std::vector<cv::KeyPoint>* k1, cv::Mat* d1, std::vector<Eigen::Vector3d>* b1, cv::Size s1, std::vector<cv::KeyPoint>* k2, cv::Mat* d2, std::vector<Eigen::Vector3d>* b2, cv::Size s2, double window, std::vector<cv::DMatch> *matches, int gmsGrid, double gmsRatio, int * gmsHypothesis, std::ostream & logStream);
 
 double utilesDetectMotion(std::vector<cv::KeyPoint> *kp1, std::vector<cv::KeyPoint> *kp2, std::vector<cv::DMatch> *matches, cv::Size size);
+cv::Mat utilesThumbnail(cv::Mat * image, int width);
+double utilesThumbnailMotion(cv::Mat * thumbLast, cv::Mat * thumbNew, cv::Mat * thumbMask);
 
 double bilinear_sample(double *p, double x, double y, int width);
 
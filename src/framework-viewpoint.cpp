@@ -21,6 +21,15 @@
 
 #include "framework-viewpoint.hpp"
 
+Viewpoint::~Viewpoint(){
+
+    // Delete viewpoint features
+    for(auto & feature: features){
+        delete feature;
+    }
+
+}
+
 unsigned int Viewpoint::getIndex(){
 
     // Return viewpoint index
@@ -35,6 +44,27 @@ cv::Mat * Viewpoint::getImage(){
 
 }
 
+cv::Size Viewpoint::getSize(){
+
+    // Return image size - kept after image release
+    return cv::Size(width, height);
+
+}
+
+size_t Viewpoint::getMemory(){
+
+    // Image and descriptors memory
+    size_t memory(image.total()*image.elemSize()+cvDescriptor.total()*cvDescriptor.elemSize());
+
+    // Keypoints and features memory
+    memory+=cvFeatures.capacity()*sizeof(cv::KeyPoint);
+    memory+=features.capacity()*sizeof(Feature *)+features.size()*sizeof(Feature);
+
+    // Return memory estimation
+    return memory;
+
+}
+
 std::vector<cv::KeyPoint> * Viewpoint::getCvFeatures(){
 
     // Return features array
@@ -73,7 +103,35 @@ Eigen::Vector3d * Viewpoint::getPosition(){
 void Viewpoint::releaseImage(){
 
     // Release image memory
-    image.deallocate();
+    image.release();
+
+}
+
+void Viewpoint::freeze(){
+
+    // Release image, descriptors and keypoints - no more matched
+    image.release();
+    cvDescriptor.release();
+    std::vector<cv::KeyPoint>().swap(cvFeatures);
+
+    // Drop unstructured features
+    releaseFeatures();
+
+}
+
+void Viewpoint::releaseFeatures(){
+
+    // Compact features on the ones supporting a structure
+    unsigned int index(0);
+    for(unsigned int i(0); i<features.size(); i++){
+        if(features[i]->getStructure()!=NULL){
+            features[index++]=features[i];
+        }else{
+            delete features[i];
+        }
+    }
+    features.resize(index);
+    features.shrink_to_fit();
 
 }
 
@@ -99,17 +157,14 @@ void Viewpoint::setIndex(unsigned int newIndex){
 
 }
 
-bool Viewpoint::setImage(std::string imagePath, double imageScale){
+bool Viewpoint::setImage(std::string imagePath, double imageScale, int decodeMode){
 
-    // Import viewpoint image
-    image = cv::imread(imagePath, cv::IMREAD_COLOR);
+    // Import and scale viewpoint image
+    image = utilesImportImage(imagePath, imageScale, decodeMode);
 
     // Check status
     if(image.empty()==false){
 
-        // Apply image scale factor
-        cv::resize(image, image, cv::Size(), imageScale, imageScale, cv::INTER_AREA);
-
         // Assign image size
         width=image.cols;
         height=image.rows;
@@ -28,6 +28,7 @@
 
 // Internal includes
 #include "framework-feature.hpp"
+#include "framework-utiles.hpp"
 
 // Module object
 class Viewpoint {
@@ -45,18 +46,23 @@ public: /* Need to be set back to private */
     Eigen::Vector3d position;
 
 public:
+    ~Viewpoint();
     unsigned int getIndex();
     cv::Mat * getImage();
+    cv::Size getSize();
+    size_t getMemory();
     std::vector<cv::KeyPoint> * getCvFeatures();
     Feature * getFeatureFromCvIndex(int index);
     cv::Mat * getCvDescriptor();
     Eigen::Matrix3d * getOrientation();
     Eigen::Vector3d * getPosition();
     void releaseImage();
+    void freeze();
+    void releaseFeatures();
     void resetFrame();
     void addFeature(Feature * newFeature);
     void setIndex(unsigned int newIndex);
-    bool setImage(std::string imagePath, double imageScale);
+    bool setImage(std::string imagePath, double imageScale, int decodeMode);
     void setPose(Eigen::Matrix3d newOrientation, Eigen::Vector3d newPosition);
     void setPosition(Eigen::Vector3d newPosition);
     void allocateFeaturesFromCvFeatures();  
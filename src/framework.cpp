@@ -86,7 +86,10 @@ int main(int argc, char ** argv){
         yamlAlgorithm["radius"].as<double>(),
         yamlAlgorithm["group"].as<unsigned int>(),
         yamlMatching["range"].as<unsigned int>(),
-        yamlDense["disparity"].as<double>()
+        yamlMatching["minimum"].IsDefined() ? yamlMatching["minimum"].as<unsigned int>() : yamlMatching["range"].as<unsigned int>(),
+        yamlMatching["overlap"].IsDefined() ? yamlMatching["overlap"].as<unsigned int>() : DB_MATCH_OVERLAP,
+        yamlDense["disparity"].as<double>(),
+        structureMode(yamlAlgorithm["triangulation"].IsDefined() ? yamlAlgorithm["triangulation"].as<std::string>() : "pairwise")
     );
 
     // Framework front-end
@@ -103,6 +106,17 @@ int main(int argc, char ** argv){
     bool pipeFlag(true);
     bool loopFlag(true);
 
+    // Optimisation iteration in fused sweeps
+    bool algorithmFused(yamlAlgorithm["fused"].IsDefined() ? yamlAlgorithm["fused"].as<bool>() : false);
+
+    // Fused iteration compared against separate passes
+    bool algorithmCheck(yamlAlgorithm["check"].IsDefined() ? yamlAlgorithm["check"].as<bool>() : false);
+
+    // Triangulation benchmark runs on the separate optimisation steps only
+    if((algorithmFused==true)&&(database.configTriangulation==STRUCTURE_TRIANGULATION_BENCHMARK)){
+        throw std::runtime_error("Error : triangulation benchmark cannot be used with fused iteration");
+    }
+
     // Algorithm state
     int loopState(DB_MODE_NULL);
 
@@ -110,15 +124,18 @@ int main(int argc, char ** argv){
     //  Framework exportation
     //
 
+    // Exportation mode - odometry of the track front-end exported as sparse for the dense step
+    std::string exportMode(yamlFrontend["type"].as<std::string>() == "track" ? "sparse" : yamlFrontend["type"].as<std::string>());
+
     // Create exportation directories
-    utilesDirectories(yamlExport["path"].as<std::string>(), yamlFrontend["type"].as<std::string>());
+    utilesDirectories(yamlExport["path"].as<std::string>(), exportMode);
 
     //
     //  Framework front-end
     //
 
-    // Switch on front-end : odometry (sparse), densification (dense)
-    if(yamlFrontend["type"].as<std::string>() == "sparse"){
+    // Switch on front-end : odometry (sparse, track), densification (dense)
+    if((yamlFrontend["type"].as<std::string>() == "sparse")||(yamlFrontend["type"].as<std::string>() == "track")){
 
         // Detect image list boundary
         std::string firstFile = yamlFrontend["first"].IsDefined() ? yamlFrontend["first"].as<std::string>() : "";
@@ -130,17 +147,60 @@ int main(int argc, char ** argv){
             firstFile,
             lastFile, 
             yamlFrontend["step"].as<uint32_t>(),
-            yamlFrontend["scale"].as<double>()
+            yamlFrontend["scale"].as<double>(),
+            utilesDecodeMode(yamlFrontend["decode"].IsDefined() ? yamlFrontend["decode"].as<std::string>() : "full")
         );
 
+        // Front-end source decoding ahead
+        if(yamlFrontend["prefetch"].IsDefined()){
+            source = new SourcePrefetch(
+                source,
+                yamlFrontend["prefetch"]["threads"].as<unsigned int>(),
+                yamlFrontend["prefetch"]["depth"].as<unsigned int>(),
+                yamlFrontend["prefetch"]["memory"].IsDefined() ? yamlFrontend["prefetch"]["memory"].as<size_t>()*1024*1024 : 0
+            );
+        }
+
         // Import mask image
         cv::Mat mask = cv::imread(yamlFrontend["mask"].as<std::string>(), cv::IMREAD_GRAYSCALE);
 
         // Apply scale factor on mask image
         cv::resize(mask, mask, cv::Size(), yamlFrontend["scale"].as<double>(), yamlFrontend["scale"].as<double>(), cv::INTER_NEAREST );
 
-        // Create front-end instance
-        frontend = new FrontendPicture(source, mask, &database, yamlFeatures["threshold"].as<float>());
+        // Create front-end instance - features tracking
+        if(yamlFrontend["type"].as<std::string>() == "track"){
+            frontend = new FrontendTrack(
+                source,
+                mask,
+                &database,
+                yamlFeatures["threshold"].as<float>(),
+                utilesTilesMode(yamlFeatures["tiles"].IsDefined() ? yamlFeatures["tiles"].as<std::string>() : "0"),
+                yamlFrontend["track"]["period"].IsDefined() ? yamlFrontend["track"]["period"].as<int>() : 0,
+                yamlFrontend["track"]["cell"  ].IsDefined() ? yamlFrontend["track"]["cell"  ].as<int>() : 16,
+                yamlFrontend["track"]["window"].IsDefined() ? yamlFrontend["track"]["window"].as<int>() : 21,
+                yamlFrontend["track"]["levels"].IsDefined() ? yamlFrontend["track"]["levels"].as<int>() : 3,
+                yamlFrontend["gate"].IsDefined() ? yamlFrontend["gate"].as<double>()*M_PI/180. : 0.
+            );
+        } else {
+
+            // Create front-end instance - features matching
+            frontend = new FrontendPicture(
+                source,
+                mask,
+                &database,
+                yamlFeatures["threshold"].as<float>(),
+                utilesTilesMode(yamlFeatures["tiles"].IsDefined() ? yamlFeatures["tiles"].as<std::string>() : "0"),
+                yamlFeatures["budget"].IsDefined() ? yamlFeatures["budget"].as<unsigned int>() : 0,
+                yamlFeatures["cache"].IsDefined() && yamlFeatures["cache"].as<bool>() ? yamlExport["path"].as<std::string>() + "/cache" : "",
+                matcherMode(yamlMatching["matcher"].IsDefined() ? yamlMatching["matcher"].as<std::string>() : "brute"),
+                yamlMatching["guided"].IsDefined() ? yamlMatching["guided"].as<double>()*M_PI/180. : 0.,
+                sphereMode(yamlMatching["grid"].IsDefined() ? yamlMatching["grid"].as<std::string>() : "planar"),
+                yamlMatching["prior"].IsDefined() ? yamlMatching["prior"].as<double>() : 0.,
+                yamlFrontend["gate"].IsDefined() ? yamlFrontend["gate"].as<double>()*M_PI/180. : 0.,
+                yamlMatching["index"].IsDefined() ? yamlMatching["index"].as<bool>() : false
+            );
+
+        }
 
         // Initialise algorithm state
         loopState = DB_MODE_BOOT;
@@ -159,9 +219,20 @@ int main(int argc, char ** argv){
             firstFile,
             lastFile,
             yamlFrontend["step"].as<uint32_t>(),
-            yamlFrontend["scale"].as<double>()
+            yamlFrontend["scale"].as<double>(),
+            utilesDecodeMode(yamlFrontend["decode"].IsDefined() ? yamlFrontend["decode"].as<std::string>() : "full")
         );
 
+        // Front-end source decoding ahead
+        if(yamlFrontend["prefetch"].IsDefined()){
+            source = new SourcePrefetch(
+                source,
+                yamlFrontend["prefetch"]["threads"].as<unsigned int>(),
+                yamlFrontend["prefetch"]["depth"].as<unsigned int>(),
+                yamlFrontend["prefetch"]["memory"].IsDefined() ? yamlFrontend["prefetch"]["memory"].as<size_t>()*1024*1024 : 0
+            );
+        }
+
         // Import mask image
         cv::Mat mask = cv::imread(yamlFrontend["mask"].as<std::string>(), cv::IMREAD_GRAYSCALE);
 
@@ -219,25 +290,35 @@ int main(int argc, char ** argv){
             // Optimisation loop
             while ( loopFlag == true ) {
 
-                // Algorithm core
-                database.computeModels(loopState);
-                database.computeCentroids(loopState);
-                database.computeCorrelations(loopState);
-                database.computePoses(loopState);
-                database.computeNormalisePoses(loopState);
-                database.computeFrames(loopState);
-                database.computeOriented(loopState);
-                database.computeOptimals(loopState);
-                database.computeRadii(loopState);
+                // Algorithm core - fused sweeps or separate passes
+                if(algorithmFused==true){
 
-                // Stability filtering - radial limitation
-                database.filterRadialRange(loopState);
+                    // Algorithm core
+                    database.computeFused(loopState, algorithmCheck);
+
+                }else{
+
+                    // Algorithm core
+                    database.computeModels(loopState);
+                    database.computeCentroids(loopState);
+                    database.computeCorrelations(loopState);
+                    database.computePoses(loopState);
+                    database.computeNormalisePoses(loopState);
+                    database.computeFrames(loopState);
+                    database.computeOriented(loopState);
+                    database.computeOptimals(loopState);
+                    database.computeRadii(loopState);
+
+                    // Stability filtering - radial limitation
+                    database.filterRadialRange(loopState);
+
+                    // Statistics computation on disparity
+                    database.computeDisparityStatistics(loopState);
 
-                // Statistics computation on disparity
-                database.computeDisparityStatistics(loopState);
+                    // Filtering on disparity
+                    database.filterDisparity(loopState);
 
-                // Filtering on disparity
-                database.filterDisparity(loopState);
+                }
 
                 /* Iteration end condition */
                 loopFlag=database.getError(loopState, loopMajor, loopMinor);
@@ -287,10 +368,10 @@ int main(int argc, char ** argv){
         database.expungeStructures();
 
         // Major iteration exportation : model, odometry, transformation and constraint
-        database.exportStructure     (yamlExport["path"].as<std::string>(),yamlFrontend["type"].as<std::string>(),loopMajor,yamlExport["group"].as<unsigned int>());
-        database.exportPosition      (yamlExport["path"].as<std::string>(),yamlFrontend["type"].as<std::string>(),loopMajor);
-        database.exportTransformation(yamlExport["path"].as<std::string>(),yamlFrontend["type"].as<std::string>(),loopMajor);
-        database.exportConstraint    (yamlExport["path"].as<std::string>(),yamlFrontend["type"].as<std::string>(),loopMajor,yamlExport["group"].as<unsigned int>());
+        database.exportStructure     (yamlExport["path"].as<std::string>(),exportMode,loopMajor,yamlExport["group"].as<unsigned int>());
+        database.exportPosition      (yamlExport["path"].as<std::string>(),exportMode,loopMajor);
+        database.exportTransformation(yamlExport["path"].as<std::string>(),exportMode,loopMajor);
+        database.exportConstraint    (yamlExport["path"].as<std::string>(),exportMode,loopMajor,yamlExport["group"].as<unsigned int>());
 
         // update major iterator
         loopMajor ++;
@@ -32,126 +32,198 @@
 
 int gms_matcher::GetInlierMask(vector<bool> &vbInliers, bool WithScale, bool WithRotation) {
 
+	int Hypothesis = 0;
+
+	// Hypotheses in the exhaustive order
+	mvHypotheses.clear();
+	for (int Scale = 0; Scale < (WithScale ? 5 : 1); Scale++)
+	{
+		for (int RotationType = 1; RotationType <= (WithRotation ? 8 : 1); RotationType++)
+		{
+			mvHypotheses.push_back(Scale * 8 + RotationType - 1);
+		}
+	}
+
+	ResetHypotheses();
+	EvaluateHypotheses(0, mvHypotheses.size());
+
+	return BestHypothesis(vbInliers, Hypothesis);
+}
+
+int gms_matcher::GetInlierMaskPrior(vector<bool> &vbInliers, int &Hypothesis, double Ratio, int &Evaluated) {
+
 	int max_inlier = 0;
 
-	if (!WithScale && !WithRotation)
+	// Prior hypothesis first, then the remaining ones in the exhaustive order
+	mvHypotheses.assign(1, Hypothesis);
+	for (int h = 0; h < GMS_HYPOTHESES; h++)
 	{
-		SetScale(0);
-		max_inlier = run(1);
-		vbInliers = mvbInlierMask;
-		return max_inlier;
+		if (h != Hypothesis) mvHypotheses.push_back(h);
 	}
 
-	if (WithRotation && WithScale)
+	ResetHypotheses();
+
+	// Evaluate prior hypothesis, then one scale at a time - early stop on inlier ratio
+	Evaluated = 0;
+	while (Evaluated < GMS_HYPOTHESES)
 	{
-		for (int Scale = 0; Scale < 5; Scale++)
+		int Batch = 1;
+		if (Evaluated > 0)
 		{
-			SetScale(Scale);
-			for (int RotationType = 1; RotationType <= 8; RotationType++)
-			{
-				int num_inlier = run(RotationType);
+			while (Evaluated + Batch < GMS_HYPOTHESES && mvHypotheses[Evaluated + Batch] / 8 == mvHypotheses[Evaluated] / 8) Batch++;
+		}
 
-				if (num_inlier > max_inlier)
-				{
-					vbInliers = mvbInlierMask;
-					max_inlier = num_inlier;
-				}
-			}
+		EvaluateHypotheses(Evaluated, Evaluated + Batch);
+		Evaluated += Batch;
+
+		max_inlier = 0;
+		for (auto &ws : mWorkspaces)
+		{
+			max_inlier = max(max_inlier, ws.BestInlier);
 		}
-		return max_inlier;
+
+		if (max_inlier >= Ratio * mNumberMatches)
+			break;
 	}
 
-	if (WithRotation && !WithScale)
+	return BestHypothesis(vbInliers, Hypothesis);
+}
+
+void gms_matcher::ResetHypotheses() {
+
+	for (auto &ws : mWorkspaces)
 	{
-		SetScale(0);
-		for (int RotationType = 1; RotationType <= 8; RotationType++)
-		{
-			int num_inlier = run(RotationType);
+		ws.BestInlier = 0;
+		ws.BestOrder = INT_MAX;
+	}
+}
 
-			if (num_inlier > max_inlier)
-			{
-				vbInliers = mvbInlierMask;
-				max_inlier = num_inlier;
-			}
+void gms_matcher::EvaluateHypotheses(int Begin, int End) {
+
+	// Nested calls are evaluated by the calling thread only
+	int threads = omp_in_parallel() ? 1 : min(End - Begin, omp_get_max_threads());
+
+	// Allocate missing workspaces
+	size_t allocated = mWorkspaces.size();
+	if (allocated < (size_t)threads)
+	{
+		mWorkspaces.resize(threads);
+		for (size_t i = allocated; i < mWorkspaces.size(); i++)
+		{
+			mWorkspaces[i].MotionStatistics.assign(mGridNumberLeft * mGridNumberRight[4], 0);
+			mWorkspaces[i].BestInlier = 0;
+			mWorkspaces[i].BestOrder = INT_MAX;
 		}
-		return max_inlier;
 	}
 
-	if (!WithRotation && WithScale)
+	#pragma omp parallel for num_threads(threads) schedule(dynamic)
+	for (int k = Begin; k < End; k++)
 	{
-		for (int Scale = 0; Scale < 5; Scale++)
+		gms_workspace &ws = mWorkspaces[omp_get_thread_num()];
+
+		int h = mvHypotheses[k];
+		int num_inlier = run(h % 8 + 1, h / 8, ws);
+
+		// Keep the workspace best - first evaluated on ties
+		if (num_inlier > ws.BestInlier || (num_inlier == ws.BestInlier && num_inlier > 0 && k < ws.BestOrder))
 		{
-			SetScale(Scale);
+			ws.BestMask.swap(ws.InlierMask);
+			ws.BestInlier = num_inlier;
+			ws.BestOrder = k;
+			ws.BestHypothesis = h;
+		}
+	}
+}
 
-			int num_inlier = run(1);
+int gms_matcher::BestHypothesis(vector<bool> &vbInliers, int &Hypothesis) {
 
-			if (num_inlier > max_inlier)
-			{
-				vbInliers = mvbInlierMask;
-				max_inlier = num_inlier;
-			}
+	gms_workspace *best = NULL;
 
+	for (auto &ws : mWorkspaces)
+	{
+		if (ws.BestInlier == 0) continue;
+		if (best == NULL || ws.BestInlier > best->BestInlier || (ws.BestInlier == best->BestInlier && ws.BestOrder < best->BestOrder))
+		{
+			best = &ws;
 		}
-		return max_inlier;
 	}
 
-	return max_inlier;
+	vbInliers.assign(mNumberMatches, false);
+
+	if (best == NULL)
+		return 0;
+
+	for (size_t i = 0; i < mNumberMatches; i++)
+	{
+		vbInliers[i] = best->BestMask[i];
+	}
+
+	Hypothesis = best->BestHypothesis;
+	return best->BestInlier;
 }
 
-void gms_matcher::AssignMatchPairs(int GridType) {
+void gms_matcher::AssignMatchPairs(int GridType, int Scale, gms_workspace &ws) {
+
+	const int GridNumberRight = mGridNumberRight[Scale];
 
 	for (size_t i = 0; i < mNumberMatches; i++)
 	{
 		Point2f &lp = mvP1[mvMatches[i].first];
 		Point2f &rp = mvP2[mvMatches[i].second];
 
-		int lgidx = mvMatchPairs[i].first = GetGridIndexLeft(lp, GridType);
+		int lgidx = ws.MatchPairs[i].first = GetGridIndexLeft(lp, GridType);
 		int rgidx = -1;
 
 		if (GridType == 1)
 		{
-			rgidx = mvMatchPairs[i].second = GetGridIndexRight(rp);
+			rgidx = ws.MatchPairs[i].second = GetGridIndexRight(rp, Scale);
 		}
 		else
 		{
-			rgidx = mvMatchPairs[i].second;
+			rgidx = ws.MatchPairs[i].second;
 		}
 
 		if (lgidx < 0 || rgidx < 0)	continue;
 
-		mMotionStatistics.at<int>(lgidx, rgidx)++;
-		mNumberPointsInPerCellLeft[lgidx]++;
+		ws.MotionStatistics[lgidx * GridNumberRight + rgidx]++;
+		ws.NumberPointsInPerCellLeft[lgidx]++;
+	}
+
+	// Most populated right cell of every left cell - lowest index on ties
+	for (size_t i = 0; i < mNumberMatches; i++)
+	{
+		int lgidx = ws.MatchPairs[i].first;
+		int rgidx = ws.MatchPairs[i].second;
+
+		if (lgidx < 0 || rgidx < 0)	continue;
+
+		int value = ws.MotionStatistics[lgidx * GridNumberRight + rgidx];
+		if (value > ws.CellBest[lgidx] || (value == ws.CellBest[lgidx] && rgidx < ws.CellPairs[lgidx]))
+		{
+			ws.CellBest[lgidx] = value;
+			ws.CellPairs[lgidx] = rgidx;
+		}
 	}
 
 }
 
-void gms_matcher::VerifyCellPairs(int RotationType) {
+void gms_matcher::VerifyCellPairs(int RotationType, int Scale, gms_workspace &ws) {
 
 	const int *CurrentRP = mRotationPatterns[RotationType - 1];
+	const int GridNumberRight = mGridNumberRight[Scale];
 
 	for (int i = 0; i < mGridNumberLeft; i++)
 	{
-		if (sum(mMotionStatistics.row(i))[0] == 0)
+		if (ws.NumberPointsInPerCellLeft[i] == 0)
 		{
-			mCellPairs[i] = -1;
+			ws.CellPairs[i] = -1;
 			continue;
 		}
 
-		int max_number = 0;
-		for (int j = 0; j < mGridNumberRight; j++)
-		{
-			int *value = mMotionStatistics.ptr<int>(i);
-			if (value[j] > max_number)
-			{
-				mCellPairs[i] = j;
-				max_number = value[j];
-			}
-		}
-
-		int idx_grid_rt = mCellPairs[i];
+		int idx_grid_rt = ws.CellPairs[i];
 
-		const int *NB9_lt = mGridNeighborLeft.ptr<int>(i);
-		const int *NB9_rt = mGridNeighborRight.ptr<int>(idx_grid_rt);
+		const int *NB9_lt = &mGridNeighborLeft[i * 9];
+		const int *NB9_rt = &mGridNeighborRight[Scale][idx_grid_rt * 9];
 
 		int score = 0;
 		double thresh = 0;
@@ -163,47 +235,58 @@ void gms_matcher::VerifyCellPairs(int RotationType) {
 			int rr = NB9_rt[CurrentRP[j] - 1];
 			if (ll == -1 || rr == -1)	continue;
 
-			score += mMotionStatistics.at<int>(ll, rr);
-			thresh += mNumberPointsInPerCellLeft[ll];
+			score += ws.MotionStatistics[ll * GridNumberRight + rr];
+			thresh += ws.NumberPointsInPerCellLeft[ll];
 			numpair++;
 		}
 
 		thresh = THRESH_FACTOR * sqrt(thresh / numpair);
 
 		if (score < thresh)
-			mCellPairs[i] = -2;
+			ws.CellPairs[i] = -2;
 	}
 }
 
-int gms_matcher::run(int RotationType) {
+int gms_matcher::run(int RotationType, int Scale, gms_workspace &ws) {
 
-	mvbInlierMask.assign(mNumberMatches, false);
+	const int GridNumberRight = mGridNumberRight[Scale];
 
-	// Initialize Motion Statisctics
-	mMotionStatistics = Mat::zeros(mGridNumberLeft, mGridNumberRight, CV_32SC1);
-	mvMatchPairs.assign(mNumberMatches, pair<int, int>(0, 0));
+	ws.InlierMask.assign(mNumberMatches, 0);
+	ws.MatchPairs.assign(mNumberMatches, pair<int, int>(0, 0));
 
 	for (int GridType = 1; GridType <= 4; GridType++)
 	{
 		// initialize
-		mMotionStatistics.setTo(0);
-		mCellPairs.assign(mGridNumberLeft, -1);
-		mNumberPointsInPerCellLeft.assign(mGridNumberLeft, 0);
+		ws.CellPairs.assign(mGridNumberLeft, -1);
+		ws.CellBest.assign(mGridNumberLeft, 0);
+		ws.NumberPointsInPerCellLeft.assign(mGridNumberLeft, 0);
 
-		AssignMatchPairs(GridType);
-		VerifyCellPairs(RotationType);
+		AssignMatchPairs(GridType, Scale, ws);
+		VerifyCellPairs(RotationType, Scale, ws);
 
 		// Mark inliers
 		for (size_t i = 0; i < mNumberMatches; i++)
 		{
-			if (mvMatchPairs[i].first >= 0) {
-				if (mCellPairs[mvMatchPairs[i].first] == mvMatchPairs[i].second)
+			if (ws.MatchPairs[i].first >= 0 && ws.MatchPairs[i].second >= 0) {
+				if (ws.CellPairs[ws.MatchPairs[i].first] == ws.MatchPairs[i].second)
 				{
-					mvbInlierMask[i] = true;
+					ws.InlierMask[i] = 1;
 				}
 			}
 		}
+
+		// Clear used motion statistics
+		for (size_t i = 0; i < mNumberMatches; i++)
+		{
+			if (ws.MatchPairs[i].first >= 0 && ws.MatchPairs[i].second >= 0)
+				ws.MotionStatistics[ws.MatchPairs[i].first * GridNumberRight + ws.MatchPairs[i].second] = 0;
+		}
+	}
+
+	int num_inlier = 0;
+	for (size_t i = 0; i < mNumberMatches; i++)
+	{
+		num_inlier += ws.InlierMask[i];
 	}
-	int num_inlier = sum(mvbInlierMask)[0];
 	return num_inlier;
 }
@@ -34,6 +34,8 @@
 #include <vector>
 #include <iostream>
 #include <ctime>
+#include <climits>
+#include <omp.h>
 using namespace std;
 using namespace cv;
 
@@ -79,28 +81,74 @@ const int mRotationPatterns[8][9] = {
 // 5 level scales
 const double mScaleRatios[5] = { 1.0, 1.0 / 2, 1.0 / sqrt(2.0), sqrt(2.0), 2.0 };
 
+// Number of scale and rotation hypotheses
+#define GMS_HYPOTHESES 40
+
+// Left grid size
+#define GMS_GRID_LEFT 20
+
+// Statistic buffers of one hypothesis evaluation thread
+struct gms_workspace
+{
+	// Motion statistics (left cell x right cell), cleared sparsely after each grid type
+	vector<int> MotionStatistics;
+
+	// Per left cell buffers
+	vector<int> NumberPointsInPerCellLeft;
+	vector<int> CellPairs;
+	vector<int> CellBest;
+
+	// Cell pair of every match
+	vector<pair<int, int> > MatchPairs;
+
+	// Inlier masks of the current and of the best evaluated hypothesis
+	vector<char> InlierMask;
+	vector<char> BestMask;
+
+	// Best evaluated hypothesis inliers and evaluation order
+	int BestInlier;
+	int BestOrder;
+	int BestHypothesis;
+};
+
 
 class gms_matcher
 {
 public:
+	// Reusable engine - neighbor tables computed once for every grid size
+	gms_matcher()
+	{
+		// Left grid initialize
+		mGridSizeLeft = Size(GMS_GRID_LEFT, GMS_GRID_LEFT);
+		mGridNumberLeft = mGridSizeLeft.width * mGridSizeLeft.height;
+		InitalizeNiehbors(mGridNeighborLeft, mGridSizeLeft);
+
+		// Right grids initialize
+		for (int Scale = 0; Scale < 5; Scale++)
+		{
+			mGridSizeRight[Scale].width = mGridSizeLeft.width  * mScaleRatios[Scale];
+			mGridSizeRight[Scale].height = mGridSizeLeft.height * mScaleRatios[Scale];
+			mGridNumberRight[Scale] = mGridSizeRight[Scale].width * mGridSizeRight[Scale].height;
+			InitalizeNiehbors(mGridNeighborRight[Scale], mGridSizeRight[Scale]);
+		}
+	};
+
 	// OpenCV Keypoints & Correspond Image Size & Nearest Neighbor Matches
-	gms_matcher(const vector<KeyPoint> &vkp1, const Size size1, const vector<KeyPoint> &vkp2, const Size size2, const vector<DMatch> &vDMatches)
+	gms_matcher(const vector<KeyPoint> &vkp1, const Size size1, const vector<KeyPoint> &vkp2, const Size size2, const vector<DMatch> &vDMatches) : gms_matcher()
+	{
+		Initialize(vkp1, size1, vkp2, size2, vDMatches);
+	};
+	~gms_matcher() {};
+
+	// Assign a new image pair - buffers are kept
+	void Initialize(const vector<KeyPoint> &vkp1, const Size size1, const vector<KeyPoint> &vkp2, const Size size2, const vector<DMatch> &vDMatches)
 	{
 		// Input initialize
 		NormalizePoints(vkp1, size1, mvP1);
 		NormalizePoints(vkp2, size2, mvP2);
 		mNumberMatches = vDMatches.size();
 		ConvertMatches(vDMatches, mvMatches);
-
-		// Grid initialize
-		mGridSizeLeft = Size(20, 20);
-		mGridNumberLeft = mGridSizeLeft.width * mGridSizeLeft.height;
-
-		// Initialize the neihbor of left grid
-		mGridNeighborLeft = Mat::zeros(mGridNumberLeft, 9, CV_32SC1);
-		InitalizeNiehbors(mGridNeighborLeft, mGridSizeLeft);
 	};
-	~gms_matcher() {};
 
 private:
 
@@ -114,33 +162,19 @@ private:
 	size_t mNumberMatches;
 
 	// Grid Size
-	Size mGridSizeLeft, mGridSizeRight;
+	Size mGridSizeLeft, mGridSizeRight[5];
 	int mGridNumberLeft;
-	int mGridNumberRight;
-
-	// x	  : left grid idx
-	// y      :  right grid idx
-	// value  : how many matches from idx_left to idx_right
-	Mat mMotionStatistics;
-
-	//
-	vector<int> mNumberPointsInPerCellLeft;
-
-	// Inldex  : grid_idx_left
-	// Value   : grid_idx_right
-	vector<int> mCellPairs;
+	int mGridNumberRight[5];
 
-	// Every Matches has a cell-pair
-	// first  : grid_idx_left
-	// second : grid_idx_right
-	vector<pair<int, int> > mvMatchPairs;
+	// Neighbor tables - 9 cells per grid cell
+	vector<int> mGridNeighborLeft;
+	vector<int> mGridNeighborRight[5];
 
-	// Inlier Mask for output
-	vector<bool> mvbInlierMask;
+	// Hypothesis evaluation workspaces - one per thread
+	vector<gms_workspace> mWorkspaces;
 
-	//
-	Mat mGridNeighborLeft;
-	Mat mGridNeighborRight;
+	// Hypotheses evaluation order
+	vector<int> mvHypotheses;
 
 public:
 
@@ -148,6 +182,12 @@ public:
 	// Return number of inliers
 	int GetInlierMask(vector<bool> &vbInliers, bool WithScale = false, bool WithRotation = false);
 
+	// Get Inlier Mask trying the prior hypothesis first and stopping once the inlier ratio is reached
+	// Hypothesis : Scale * 8 + RotationType - 1, replaced by the retained hypothesis
+	// Evaluated  : number of evaluated hypotheses
+	// Return number of inliers
+	int GetInlierMaskPrior(vector<bool> &vbInliers, int &Hypothesis, double Ratio, int &Evaluated);
+
 private:
 
 	// Normalize Key Points to Range(0 - 1)
@@ -215,23 +255,25 @@ private:
 		return x + y * mGridSizeLeft.width;
 	}
 
-	int GetGridIndexRight(const Point2f &pt) {
-		int x = floor(pt.x * mGridSizeRight.width);
-		int y = floor(pt.y * mGridSizeRight.height);
+	int GetGridIndexRight(const Point2f &pt, int Scale) {
+		int x = floor(pt.x * mGridSizeRight[Scale].width);
+		int y = floor(pt.y * mGridSizeRight[Scale].height);
 
-		return x + y * mGridSizeRight.width;
+		if (x < 0 || y < 0 || x >= mGridSizeRight[Scale].width || y >= mGridSizeRight[Scale].height) {
+			return -1;
+		}
+
+		return x + y * mGridSizeRight[Scale].width;
 	}
 
 	// Assign Matches to Cell Pairs
-	void AssignMatchPairs(int GridType);
+	void AssignMatchPairs(int GridType, int Scale, gms_workspace &ws);
 
 	// Verify Cell Pairs
-	void VerifyCellPairs(int RotationType);
+	void VerifyCellPairs(int RotationType, int Scale, gms_workspace &ws);
 
 	// Get Neighbor 9
-	vector<int> GetNB9(const int idx, const Size& GridSize) {
-		vector<int> NB9(9, -1);
-
+	void GetNB9(const int idx, const Size& GridSize, int *NB9) {
 		int idx_x = idx % GridSize.width;
 		int idx_y = idx / GridSize.width;
 
@@ -242,36 +284,33 @@ private:
 				int idx_xx = idx_x + xi;
 				int idx_yy = idx_y + yi;
 
+				NB9[xi + 4 + yi * 3] = -1;
+
 				if (idx_xx < 0 || idx_xx >= GridSize.width || idx_yy < 0 || idx_yy >= GridSize.height)
 					continue;
 
 				NB9[xi + 4 + yi * 3] = idx_xx + idx_yy * GridSize.width;
 			}
 		}
-		return NB9;
 	}
 
-	void InitalizeNiehbors(Mat &neighbor, const Size& GridSize) {
-		for (int i = 0; i < neighbor.rows; i++)
+	void InitalizeNiehbors(vector<int> &neighbor, const Size& GridSize) {
+		neighbor.resize(GridSize.width * GridSize.height * 9);
+		for (int i = 0; i < GridSize.width * GridSize.height; i++)
 		{
-			vector<int> NB9 = GetNB9(i, GridSize);
-			int *data = neighbor.ptr<int>(i);
-			memcpy(data, &NB9[0], sizeof(int) * 9);
+			GetNB9(i, GridSize, &neighbor[i * 9]);
 		}
 	}
 
-	void SetScale(int Scale) {
-		// Set Scale
-		mGridSizeRight.width = mGridSizeLeft.width  * mScaleRatios[Scale];
-		mGridSizeRight.height = mGridSizeLeft.height * mScaleRatios[Scale];
-		mGridNumberRight = mGridSizeRight.width * mGridSizeRight.height;
+	// Evaluate hypotheses of the evaluation order range in parallel
+	void EvaluateHypotheses(int Begin, int End);
 
-		// Initialize the neihbor of right grid
-		mGridNeighborRight = Mat::zeros(mGridNumberRight, 9, CV_32SC1);
-		InitalizeNiehbors(mGridNeighborRight, mGridSizeRight);
-	}
+	// Reset workspaces best hypothesis
+	void ResetHypotheses();
+
+	// Retrieve best evaluated hypothesis - most inliers, first evaluated on ties
+	int BestHypothesis(vector<bool> &vbInliers, int &Hypothesis);
 
 	// Run
-	int run(int RotationType);
+	int run(int RotationType, int Scale, gms_workspace &ws);
 };
-